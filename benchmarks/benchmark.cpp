@@ -78,13 +78,11 @@ int main() {
     int buffer_sizes[] = {0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80, 0x100, 0x200, 0x400, 0x800, 0x1000, 0x10000,
                           0x20000, 0x40000, 0x100000};
 
-    FILE *fp = fopen("bitio_benchmark.dat", "rb+");
-
     for (auto size : buffer_sizes) {
         std::cout << "Running benchmark with buffer size = " << size << " bytes" << std::endl << std::endl;
-        auto stream = new bitio::stream(fp, size);
-        stream->seek_to(0);
-        benchmark(stream);
+        auto stream = bitio::stream("bitio_benchmark.dat", size, 0, bitio::buffer_pool());
+        stream.seek_to(0);
+        benchmark(&stream);
     }
 
     return 0;
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <bitio/cpu.h>
+
+// Throughput of every bulk kernel at every instruction set level this machine supports.
+
+template<typename F>
+double measure(uint64_t bytes, F &&f) {
+    auto clock = std::chrono::high_resolution_clock();
+    auto start = clock.now();
+    int rounds = 0;
+    do {
+        f();
+        rounds++;
+    } while (clock.now() - start < std::chrono::milliseconds(200));
+
+    double seconds = std::chrono::duration<double>(clock.now() - start).count();
+    return double(bytes) * rounds / seconds / 1048576.0;
+}
+
+int main() {
+    const uint64_t n = 0x100000;
+    std::mt19937_64 rng(1);
+
+    std::vector<uint8_t> data(n * 8 + 1);
+    for (auto &b : data) {
+        b = rng();
+    }
+
+    std::vector<uint64_t> words(n);
+    std::vector<uint32_t> x(n), y(n), z(n);
+    std::vector<uint64_t> codes(n);
+    for (uint64_t i = 0; i < n; i++) {
+        words[i] = rng();
+        x[i] = rng();
+        y[i] = rng();
+        z[i] = rng();
+    }
+
+    std::cout << "Detected level: " << bitio::cpu_level_name(bitio::detected_cpu_level()) << std::endl << std::endl;
+
+    for (uint8_t l = 0; l <= uint8_t(bitio::detected_cpu_level()); l++) {
+        auto &k = bitio::kernels(bitio::cpu_level(l));
+        volatile uint64_t sink = 0;
+
+        std::cout << "Level: " << bitio::cpu_level_name(bitio::cpu_level(l)) << std::endl;
+        std::cout << "crc32c: " << measure(n * 8, [&] { sink = k.crc32c(0, data.data(), n * 8); })
+                  << " Megabytes/s" << std::endl;
+        std::cout << "popcount: " << measure(n * 8, [&] { sink = k.popcount(words.data(), n); })
+                  << " Megabytes/s" << std::endl;
+        std::cout << "funnel_shift: " << measure(n * 8, [&] { k.funnel_shift(data.data(), n * 8, 0, 3); })
+                  << " Megabytes/s" << std::endl;
+        std::cout << "transpose64: " << measure(n * 8, [&] {
+            for (uint64_t i = 0; i + 0x40 <= n; i += 0x40) {
+                k.transpose64(words.data() + i);
+            }
+        }) << " Megabytes/s" << std::endl;
+        std::cout << "extract_mask: " << measure(n * 8, [&] {
+            uint64_t acc = 0;
+            for (uint64_t i = 0; i < n; i++) {
+                acc += k.extract_mask(words[i], 0x0f0f00ff00f0f0f1ull);
+            }
+            sink = acc;
+        }) << " Megabytes/s" << std::endl;
+        std::cout << "morton2_encode: " << measure(n * 8, [&] {
+            k.morton2_encode(x.data(), y.data(), codes.data(), n);
+        }) << " Megabytes/s" << std::endl;
+        std::cout << "morton3_decode: " << measure(n * 8, [&] {
+            k.morton3_decode(codes.data(), x.data(), y.data(), z.data(), n);
+        }) << " Megabytes/s" << std::endl;
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <bitio/lanes.h>
+
+// Decoding 4M fields of 1-20 bits through stream::read() against a 4-lane reader.
+
+template<typename F>
+double best_ms(F &&f) {
+    auto clock = std::chrono::high_resolution_clock();
+    double best = 1e300;
+    for (int round = 0; round < 5; round++) {
+        auto start = clock.now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(clock.now() - start).count());
+    }
+    return best;
+}
+
+int main() {
+    const uint64_t groups = 0x100000;
+    std::mt19937_64 rng(1);
+
+    // Each group holds one field per lane, all of the same width.
+    std::vector<uint8_t> widths(groups);
+    std::vector<uint64_t> fields(groups * 4);
+    for (uint64_t g = 0; g < groups; g++) {
+        widths[g] = rng() % 20 + 1;
+        for (uint64_t l = 0; l < 4; l++) {
+            fields[g * 4 + l] = rng() & bitio::low_mask(widths[g]);
+        }
+    }
+
+    std::vector<uint8_t> raw(groups * 4 * 20 / 8 + 0x1000);
+    auto flat = bitio::stream(raw.data(), raw.size());
+    for (uint64_t g = 0; g < groups; g++) {
+        for (uint64_t l = 0; l < 4; l++) {
+            flat.write(fields[g * 4 + l], widths[g]);
+        }
+    }
+
+    std::vector<uint8_t> lane_raw(raw.size() + 0x100);
+    auto laned = bitio::stream(lane_raw.data(), lane_raw.size());
+    bitio::lane_writer<4> writer;
+    for (uint64_t g = 0; g < groups; g++) {
+        writer.write_all(&fields[g * 4], widths[g]);
+    }
+    writer.finish(laned);
+
+    volatile uint64_t sink = 0;
+
+    double read_ms = best_ms([&] {
+        flat.seek_to(0);
+        uint64_t acc = 0;
+        for (uint64_t g = 0; g < groups; g++) {
+            for (uint64_t l = 0; l < 4; l++) {
+                acc += flat.read(widths[g]);
+            }
+        }
+        sink = acc;
+    });
+
+    // The lane reader is timed in two parts: copying the lanes out of the stream, then decoding them.
+    auto clock = std::chrono::high_resolution_clock();
+    double copy_ms = 1e300;
+    double lanes_ms = 1e300;
+    for (int round = 0; round < 5; round++) {
+        laned.seek_to(0);
+        auto start = clock.now();
+        bitio::lane_reader<4> reader(laned);
+        auto copied = clock.now();
+
+        uint64_t acc = 0;
+        uint64_t values[4];
+        for (uint64_t g = 0; g < groups; g++) {
+            reader.read_all(values, widths[g]);
+            acc += values[0] + values[1] + values[2] + values[3];
+        }
+        sink = acc;
+
+        copy_ms = std::min(copy_ms, std::chrono::duration<double, std::milli>(copied - start).count());
+        lanes_ms = std::min(lanes_ms, std::chrono::duration<double, std::milli>(clock.now() - copied).count());
+    }
+
+    std::cout << "Fields: " << groups * 4 << std::endl;
+    std::cout << "stream::read: " << read_ms << " ms" << std::endl;
+    std::cout << "lane_reader<4> copy: " << copy_ms << " ms" << std::endl;
+    std::cout << "lane_reader<4> read_all: " << lanes_ms << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <bitio/record.h>
+
+// Packing and unpacking 1M records field by field against the schema's bulk write_all()/read_all().
+
+struct sample {
+    uint8_t type;
+    uint16_t length;
+    bool last;
+    uint64_t payload;
+    int32_t delta;
+};
+
+using sample_schema = bitio::schema<
+        bitio::field<&sample::type, 3>,
+        bitio::field<&sample::length, 12>,
+        bitio::field<&sample::last, 1>,
+        bitio::field<&sample::payload, 43>,
+        bitio::field<&sample::delta, 20>>;
+
+template<typename F>
+double best_ms(F &&f) {
+    auto clock = std::chrono::high_resolution_clock();
+    double best = 1e300;
+    for (int round = 0; round < 5; round++) {
+        auto start = clock.now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(clock.now() - start).count());
+    }
+    return best;
+}
+
+int main() {
+    const uint64_t n = 0x100000;
+    std::mt19937_64 rng(1);
+
+    std::vector<sample> records(n);
+    for (auto &r : records) {
+        r.type = rng() & 0x7;
+        r.length = rng() & 0xfff;
+        r.last = rng() & 1;
+        r.payload = rng() & 0x7ffffffffff;
+        r.delta = int32_t(rng() % (1 << 20)) - (1 << 19);
+    }
+
+    std::vector<uint8_t> raw(n * sample_schema::bits / 8 + 0x100);
+    auto stream = bitio::stream(raw.data(), raw.size());
+    std::vector<sample> out(n);
+
+    double field_write_ms = best_ms([&] {
+        stream.seek_to(0);
+        for (auto &r : records) {
+            stream.write(r.type, 3);
+            stream.write(r.length, 12);
+            stream.write(r.last, 1);
+            stream.write(r.payload, 43);
+            stream.write(uint32_t(r.delta) & 0xfffff, 20);
+        }
+    });
+
+    double bulk_write_ms = best_ms([&] {
+        stream.seek_to(0);
+        sample_schema::write_all(stream, records.data(), n);
+    });
+
+    double field_read_ms = best_ms([&] {
+        stream.seek_to(0);
+        for (auto &r : out) {
+            r.type = stream.read(3);
+            r.length = stream.read(12);
+            r.last = stream.read(1);
+            r.payload = stream.read(43);
+            r.delta = int32_t(stream.read(20) << 12) >> 12;
+        }
+    });
+
+    double bulk_read_ms = best_ms([&] {
+        stream.seek_to(0);
+        sample_schema::read_all(stream, out.data(), n);
+    });
+
+    std::cout << "Records: " << n << " of " << sample_schema::bits << " bits" << std::endl;
+    std::cout << "Field by field write: " << field_write_ms << " ms" << std::endl;
+    std::cout << "write_all: " << bulk_write_ms << " ms" << std::endl;
+    std::cout << "Field by field read: " << field_read_ms << " ms" << std::endl;
+    std::cout << "read_all: " << bulk_read_ms << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <bitio/trace.h>
+
+// Replays a trace recorded with bitio::stream::trace() against fresh streams, one per buffer size.
+//
+// Usage: bitio_replay <trace> [buffer sizes...] [--direct] [--checksum]
+
+static const char *replay_file = "bitio_replay.dat";
+
+void replay(const std::vector<bitio::trace_event> &events, uint64_t buffer_size, uint32_t flags) {
+    uint64_t size = events.empty() ? 0 : events.front().value;
+
+    std::remove(replay_file);
+    auto *tmp = fopen(replay_file, "w");
+    (void) ftruncate(fileno(tmp), size);
+    fclose(tmp);
+
+    auto stream = bitio::stream(replay_file, buffer_size, flags, bitio::buffer_pool());
+    auto clock = std::chrono::high_resolution_clock();
+    uint64_t bits = 0;
+    uint64_t failed = 0;
+
+    auto start = clock.now();
+    for (auto &event : events) {
+        try {
+            switch (event.op) {
+                case bitio::trace_op::read:
+                    stream.read(event.value);
+                    bits += event.value;
+                    break;
+                case bitio::trace_op::write:
+                    stream.write(0x5a5a5a5a5a5a5a5aull, event.value);
+                    bits += event.value;
+                    break;
+                case bitio::trace_op::seek:
+                    stream.seek(int64_t(event.value));
+                    break;
+                case bitio::trace_op::seek_to:
+                    stream.seek_to(event.value);
+                    break;
+                case bitio::trace_op::flush:
+                    stream.flush();
+                    break;
+                default:
+                    break;
+            }
+        } catch (bitio::bitio_exception &) {
+            failed++;
+        }
+    }
+    stream.flush();
+    auto elapsed = clock.now() - start;
+
+    auto &stats = stream.stats();
+    double seconds = double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / 1e9;
+
+    std::cout << "Buffer size: " << buffer_size << " bytes" << std::endl;
+    std::cout << "Throughput: " << double(bits) / 8.0 / 1048576.0 / seconds << " Megabytes/s ("
+              << double(events.size()) / seconds << " ops/s)" << std::endl;
+    std::cout << "Page misses: " << stats.page_loads << std::endl;
+    std::cout << "Pages written: " << stats.page_commits << std::endl;
+    std::cout << "Bytes moved: " << stats.bytes_loaded << " in, " << stats.bytes_committed << " out" << std::endl;
+    if (failed) {
+        std::cout << "Failed operations: " << failed << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace> [buffer sizes...] [--direct] [--checksum]" << std::endl;
+        return 1;
+    }
+
+    std::vector<uint64_t> buffer_sizes;
+    uint32_t flags = 0;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--direct") == 0) {
+            flags |= BITIO_DIRECT_IO;
+        } else if (std::strcmp(argv[i], "--checksum") == 0) {
+            flags |= BITIO_CHECKSUM;
+        } else {
+            buffer_sizes.push_back(std::stoull(argv[i], nullptr, 0));
+        }
+    }
+
+    if (buffer_sizes.empty()) {
+        buffer_sizes = {0x1000, 0x10000, 0x20000, 0x100000};
+    }
+
+    std::vector<bitio::trace_event> events;
+    bitio::trace_reader reader(argv[1]);
+    bitio::trace_event event{};
+    while (reader.next(event)) {
+        events.push_back(event);
+    }
+
+    if (events.empty() || events.front().op != bitio::trace_op::begin) {
+        std::cerr << "Trace does not start with a begin event" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Replaying " << events.size() << " events" << std::endl << std::endl;
+    for (auto size : buffer_sizes) {
+        replay(events, size, flags);
+    }
+
+    std::remove(replay_file);
+    return 0;
+}
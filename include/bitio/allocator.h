@@ -0,0 +1,49 @@
+#ifndef BITIO_ALLOCATOR_H
+#define BITIO_ALLOCATOR_H
+
+#include <cstdint>
+
+#define BITIO_DEFAULT_ALIGNMENT 0x40
+#define BITIO_HUGEPAGE_SIZE 0x200000
+#define BITIO_POOL_MAX_CACHED 0x10
+
+namespace bitio {
+    // Source of stream page buffers.
+    class allocator {
+    public:
+        virtual ~allocator() = default;
+
+        virtual uint8_t *allocate(uint64_t size, uint64_t alignment) = 0;
+
+        virtual void deallocate(uint8_t *ptr, uint64_t size, uint64_t alignment) = 0;
+    };
+
+    // Keeps released buffers on a thread-local free list and hands them back out for requests of the same
+    // size and alignment. The upstream allocator must outlive every thread that used the pool.
+    class pool_allocator : public allocator {
+    private:
+        allocator *_upstream;
+        uint64_t _max_cached;
+        uint64_t _id;
+
+    public:
+        explicit pool_allocator(allocator *upstream = nullptr, uint64_t max_cached = BITIO_POOL_MAX_CACHED);
+
+        ~pool_allocator() override;
+
+        uint8_t *allocate(uint64_t size, uint64_t alignment) override;
+
+        void deallocate(uint8_t *ptr, uint64_t size, uint64_t alignment) override;
+    };
+
+    // Plain aligned operator new/delete.
+    allocator *heap_allocator();
+
+    // Anonymous mappings backed by huge pages, or transparent huge pages when none are reserved.
+    allocator *hugepage_allocator();
+
+    // Process-wide pool over heap_allocator().
+    allocator *buffer_pool();
+}
+
+#endif
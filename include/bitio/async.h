@@ -0,0 +1,212 @@
+#ifndef BITIO_ASYNC_H
+#define BITIO_ASYNC_H
+
+#include <bitio/bitio.h>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bitio {
+    // Runs blocking page I/O away from the caller and arranges for the suspended coroutine to be resumed.
+    class executor {
+    public:
+        // Receives the error of the page transfer itself, if any.
+        using completion = std::function<void(std::exception_ptr)>;
+
+        virtual ~executor() = default;
+
+        virtual void submit(std::function<void()> job, std::coroutine_handle<> handle) = 0;
+
+        // The job needs the given page of the stream, executors that do their own I/O load it first. By default
+        // the job just runs through submit() and faults the page in itself.
+        virtual void submit_load(stream &s, uint64_t page, completion job, std::coroutine_handle<> handle);
+
+        // The job needs the dirty page of the stream written back.
+        virtual void submit_writeback(stream &s, completion job, std::coroutine_handle<> handle);
+    };
+
+    // Jobs run on a fixed set of worker threads. Finished coroutines are queued and resumed by poll() or wait()
+    // on the thread driving the event loop, unless resume_inline is set, in which case they resume on the worker.
+    class thread_pool_executor : public executor {
+    private:
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _jobs_cv;
+        std::condition_variable _completed_cv;
+        std::deque<std::pair<std::function<void()>, std::coroutine_handle<>>> _jobs;
+        std::deque<std::coroutine_handle<>> _completed;
+        uint64_t _in_flight{};
+        bool _resume_inline;
+        bool _stop{};
+
+        void work();
+
+    public:
+        explicit thread_pool_executor(uint32_t threads = 1, bool resume_inline = false);
+
+        ~thread_pool_executor() override;
+
+        void submit(std::function<void()> job, std::coroutine_handle<> handle) override;
+
+        // Resumes every coroutine whose I/O has finished, returns how many were resumed.
+        uint64_t poll();
+
+        // Like poll(), but blocks until at least one coroutine is ready when any I/O is in flight.
+        uint64_t wait();
+
+        [[nodiscard]] uint64_t pending();
+    };
+
+    // Awaitable wrapper over a stream. Operations that stay inside the loaded page complete synchronously
+    // without suspending. An operation that runs past the page does its in-page part and only hands the rest to
+    // the executor, which loads the next page first. Nothing happens to the stream until the operation is
+    // awaited.
+    class async_stream {
+    private:
+        enum class miss {
+            none,
+            load,
+            writeback
+        };
+
+        // In-page part of an operation, carried from await_ready() to the rest of it.
+        struct split {
+            uint64_t head{};
+            uint8_t rest{};
+        };
+
+        stream &_stream;
+        executor &_executor;
+
+        // Prepare runs in await_ready(), does the in-page part and tells which page (if any) is missing, F
+        // completes the operation afterwards.
+        template<typename Prepare, typename F>
+        class awaiter {
+        private:
+            using result_type = std::invoke_result_t<F, split &>;
+            using storage_type = std::conditional_t<std::is_void_v<result_type>, bool, result_type>;
+
+            stream &_stream;
+            executor &_executor;
+            Prepare _prepare;
+            F _op;
+            split _split{};
+            miss _miss{};
+            uint64_t _page{};
+            storage_type _result{};
+            std::exception_ptr _error;
+
+        public:
+            awaiter(stream &s, executor &ex, Prepare prepare, F op)
+                    : _stream(s), _executor(ex), _prepare(std::move(prepare)), _op(std::move(op)) {}
+
+            [[nodiscard]] bool await_ready() {
+                _miss = _prepare(_split, _page);
+                return _miss == miss::none;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                executor::completion job = [this](std::exception_ptr error) {
+                    if (error) {
+                        _error = error;
+                        return;
+                    }
+
+                    try {
+                        if constexpr (std::is_void_v<result_type>) {
+                            _op(_split);
+                        } else {
+                            _result = _op(_split);
+                        }
+                    } catch (...) {
+                        _error = std::current_exception();
+                    }
+                };
+
+                if (_miss == miss::load) {
+                    _executor.submit_load(_stream, _page, std::move(job), handle);
+                } else {
+                    _executor.submit_writeback(_stream, std::move(job), handle);
+                }
+            }
+
+            result_type await_resume() {
+                if (_miss == miss::none) {
+                    return _op(_split);
+                }
+
+                if (_error) {
+                    std::rethrow_exception(_error);
+                }
+
+                if constexpr (!std::is_void_v<result_type>) {
+                    return std::move(_result);
+                }
+            }
+        };
+
+        template<typename Prepare, typename F>
+        awaiter<Prepare, F> make_awaiter(Prepare prepare, F op) {
+            return awaiter<Prepare, F>(_stream, _executor, std::move(prepare), std::move(op));
+        }
+
+    public:
+        async_stream(stream &s, executor &ex);
+
+        [[nodiscard]] stream &sync();
+
+        // Brings the page holding the next nbits into memory. With a single page cache, ranges that cross a page
+        // boundary only guarantee the first page and the operation crossing it still suspends there.
+        auto ensure(uint64_t nbits) {
+            return make_awaiter([this, nbits](split &, uint64_t &page) {
+                page = _stream.cursor_page();
+                return nbits && !_stream.resident_bits() ? miss::load : miss::none;
+            }, [this](split &) { _stream.touch(); });
+        }
+
+        auto read(uint8_t n) {
+            return make_awaiter([this, n](split &sp, uint64_t &page) {
+                uint64_t resident = _stream.resident_bits();
+                sp.rest = n;
+                if (n > resident && resident) {
+                    sp.head = _stream.read(resident);
+                    sp.rest = n - resident;
+                }
+
+                page = _stream.cursor_page();
+                return n > resident ? miss::load : miss::none;
+            }, [this](split &sp) {
+                uint64_t value = _stream.read(sp.rest);
+                return sp.rest < 0x40 ? (sp.head << sp.rest) | value : value;
+            });
+        }
+
+        auto write(uint64_t obj, uint8_t n) {
+            return make_awaiter([this, obj, n](split &sp, uint64_t &page) {
+                uint64_t resident = _stream.resident_bits();
+                sp.rest = n;
+                if (n > resident && resident) {
+                    _stream.write(obj >> (n - resident), resident);
+                    sp.rest = n - resident;
+                }
+
+                page = _stream.cursor_page();
+                return n > resident ? miss::load : miss::none;
+            }, [this, obj](split &sp) { _stream.write(obj, sp.rest); });
+        }
+
+        auto flush() {
+            return make_awaiter([this](split &, uint64_t &) {
+                return _stream.backed() ? miss::writeback : miss::none;
+            }, [this](split &) { _stream.flush(); });
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef BITIO_BIT_READER_H
+#define BITIO_BIT_READER_H
+
+#include <bitio/bitio.h>
+#include <cstddef>
+#include <span>
+
+namespace bitio {
+    // Read-only cursor over a const in-memory buffer, for read-only mmaps, literals and buffers shared between
+    // threads. It holds a pointer, a size and a position only, so it is trivially copyable and a copy is an
+    // independent cursor over the same data. Reads past the end throw like stream::read().
+    class bit_reader {
+    private:
+        const uint8_t *_data{};
+        uint64_t _bytes{};
+        uint64_t _position{};
+
+        [[nodiscard]] inline uint64_t load(uint64_t position, uint8_t n) const;
+
+    public:
+        bit_reader() = default;
+
+        bit_reader(const uint8_t *data, uint64_t nbytes);
+
+        explicit bit_reader(std::span<const std::byte> data);
+
+        uint64_t read(uint8_t n);
+
+        // Like read(), but returns nothing and leaves the cursor alone when fewer than n bits are left.
+        [[nodiscard]] std::optional<uint64_t> try_read(uint8_t n);
+
+        // Reads without moving the cursor.
+        [[nodiscard]] uint64_t peek(uint8_t n) const;
+
+        // See stream::read_run() and stream::read_unary().
+        uint64_t read_run(bool bit, uint64_t limit = UINT64_MAX);
+
+        uint64_t read_unary();
+
+        void seek(int64_t n);
+
+        void seek_to(uint64_t n);
+
+        [[nodiscard]] uint64_t position() const;
+
+        [[nodiscard]] uint64_t size() const;
+
+        [[nodiscard]] uint64_t remaining() const;
+
+        [[nodiscard]] bool eof() const;
+
+        [[nodiscard]] const uint8_t *data() const;
+    };
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef BITIO_BIT_VIEW_H
+#define BITIO_BIT_VIEW_H
+
+#include <bitio/bitio.h>
+
+namespace bitio {
+    // Bounded window [offset, offset + nbits) of a stream with its own zero based cursor. Reads and writes go
+    // straight through the parent's pages and move its cursor; nothing is copied or allocated, views of views
+    // included. Accesses past the end of the window throw before touching the parent.
+    class bit_view {
+    private:
+        stream *_stream;
+        uint64_t _begin;
+        uint64_t _size;
+        uint64_t _position{};
+
+        inline void check(uint64_t n) const;
+
+    public:
+        bit_view(stream &s, uint64_t offset, uint64_t nbits);
+
+        // A window of this view, offset is relative to the start of the view.
+        [[nodiscard]] bit_view view(uint64_t offset, uint64_t nbits) const;
+
+        uint64_t read(uint8_t n);
+
+        void write(uint64_t obj, uint8_t n);
+
+        void seek(int64_t n);
+
+        void seek_to(uint64_t n);
+
+        [[nodiscard]] uint64_t position() const;
+
+        [[nodiscard]] uint64_t size() const;
+
+        [[nodiscard]] uint64_t remaining() const;
+
+        [[nodiscard]] bool eof() const;
+
+        // Bit offset of the view in the parent stream.
+        [[nodiscard]] uint64_t offset() const;
+
+        [[nodiscard]] stream &parent() const;
+    };
+}
+
+#endif
@@ -5,8 +5,25 @@
 #include <cstdint>
 #include <exception>
 #include <string>
+#include <future>
+#include <optional>
+#include <streambuf>
+#include <vector>
+#include <bitio/allocator.h>
+#include <bitio/page_codec.h>
 
 #define BITIO_BUFFER_SIZE 0x20000
+#define BITIO_DIRECT_ALIGNMENT 0x1000
+
+#define BITIO_STREAMING_PAGES 0x4
+
+#define BITIO_DIRECT_IO 0x1
+#define BITIO_STREAMING_IN 0x2
+#define BITIO_STREAMING_OUT 0x4
+#define BITIO_CHECKSUM 0x8
+#define BITIO_PADDED 0x10
+
+#define BITIO_READ_PADDING 0x10
 
 namespace bitio {
     const uint64_t u64_sblmasks[] = {0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80, 0x100, 0x200, 0x400, 0x800,
@@ -38,9 +55,25 @@ namespace bitio {
         [[nodiscard]] const char *what() const noexcept override;
     };
 
+    class io_engine;
+
+    class trace_recorder;
+
+    // Backing store traffic of a stream, counting the bytes actually transferred.
+    struct stream_stats {
+        uint64_t page_loads;
+        uint64_t page_commits;
+        uint64_t bytes_loaded;
+        uint64_t bytes_committed;
+    };
+
     class stream {
     private:
         uint8_t *_buffer{};
+        allocator *_allocator{};
+        uint8_t *_allocation{};
+        uint64_t _allocation_size{};
+        uint64_t _allocation_alignment{};
         uint64_t _buffer_offset{};
         uint64_t _buffer_size{};
         uint64_t _current_buffer_size{};
@@ -49,12 +82,120 @@ namespace bitio {
         uint8_t _bit_head{};
 
         FILE *_file{};
+        std::streambuf *_streambuf{};
+        bool _source_end{};
+        int _fd{-1};
+        uint64_t _direct_size{};
+        io_engine *_engine{};
+
+        uint32_t _streaming{};
+        uint64_t _ring_first{};
+        uint64_t _ring_last{};
+        uint64_t _ring_tail_size{};
+        uint64_t _emitted{};
+
+        struct page_crc {
+            uint32_t crc;
+            uint64_t length;
+        };
+
+        bool _checksums{};
+        std::vector<std::optional<page_crc>> _page_checksums;
+        std::vector<std::optional<uint32_t>> _expected_checksums;
+
+        struct page_extent {
+            uint64_t offset;
+            uint64_t stored;
+            uint64_t raw;
+        };
+
+        page_codec *_codec{};
+        std::vector<page_extent> _page_table;
+        std::vector<uint8_t> _scratch;
+        uint64_t _data_end{};
+        bool _table_dirty{};
+        uint64_t _last_loaded{};
+        uint8_t *_prefetch_buffer{};
+        uint64_t _prefetch_page{};
+        std::future<uint64_t> _prefetch;
+
+        stream_stats _stats{};
+        trace_recorder *_trace{};
+
+        bool _padded{};
+        bool _overrun{};
+
+        uint64_t _reserved{};
+        uint64_t _truncate{UINT64_MAX};
 
         bool _requires_commit{};
-        bool _reached_eof{};
+        uint64_t _dirty_begin{};
 
         inline void commit();
 
+        void release();
+
+        void open_pages(uint64_t buffer_size, uint32_t flags, allocator *alloc);
+
+        uint64_t pull(uint8_t *out, uint64_t n);
+
+        void push(const uint8_t *in, uint64_t n);
+
+        void seek_sink(uint64_t position);
+
+        void sync_sink();
+
+        void take(stream &other);
+
+        void allocate_buffer(uint64_t size, uint64_t alignment);
+
+        void deallocate_buffer();
+
+        void pad_page();
+
+        void load_ring_page(uint64_t offset);
+
+        void open_compressed();
+
+        void load_compressed_page(uint64_t offset);
+
+        void commit_compressed();
+
+        void write_page_table();
+
+        static uint64_t read_extent(int fd, const page_codec *codec, page_extent extent, uint8_t *out,
+                                    std::vector<uint8_t> &scratch);
+
+        void emit(uint64_t end);
+
+        [[nodiscard]] uint8_t *ring_page(uint64_t offset) const;
+
+        [[nodiscard]] uint64_t ring_end() const;
+
+        void record_checksum(uint64_t page, const uint8_t *data, uint64_t n, bool loaded);
+
+        [[nodiscard]] uint64_t checksum_length();
+
+        [[nodiscard]] uint32_t page_checksum(uint64_t page, uint64_t length);
+
+        inline void check_writable(uint64_t global_offset) const;
+
+        void commit_direct();
+
+        bool open_direct(const std::string &filename);
+
+        [[nodiscard]] bool backed() const;
+
+        inline void load_page(uint64_t offset);
+
+        const uint8_t *page_for_read(uint64_t global_offset, uint64_t n, uint64_t &span);
+
+        void read_bytes(uint64_t global_offset, uint8_t *out, uint64_t n);
+
+        void write_bytes(uint64_t global_offset, const uint8_t *in, uint64_t n);
+
+        uint8_t *page_for_write(uint64_t global_offset, uint64_t n, uint64_t &span);
+
         inline uint8_t read_byte(uint64_t global_offset, bool capture_eof = true);
 
         inline void write_byte(uint64_t global_offset, uint8_t byte);
@@ -62,30 +203,137 @@ namespace bitio {
         inline uint8_t read_next_byte();
 
         inline uint8_t fetch_next_byte();
+
+        [[nodiscard]] uint64_t data_end();
+
+        [[nodiscard]] uint64_t resident_bits() const;
+
+        [[nodiscard]] uint64_t cursor_page() const;
+
+        void touch();
+
+        [[nodiscard]] int io_fd() const;
+
+        uint64_t writeback_length();
+
+        void finish_writeback(uint64_t length);
+
+        void install_page(uint64_t offset, int64_t n);
+
+        friend class async_stream;
+
+        friend class io_engine;
+
+        friend class reverse_writer;
+
+        friend class streambuf;
+
+        friend void copy_bits(stream &src, uint64_t src_offset, stream &dst, uint64_t dst_offset, uint64_t nbits);
+
+        friend void move_bits(stream &s, uint64_t from, uint64_t to, uint64_t nbits);
     public:
         stream() = default;
 
-        stream(const std::string &filename, uint64_t buffer_size = BITIO_BUFFER_SIZE);
+        // A non-null codec stores every page encoded with it. Rewritten pages are appended and the page table is
+        // written on flush(), so the file only grows; BITIO_DIRECT_IO is ignored in this mode.
+        stream(const std::string &filename, uint64_t buffer_size = BITIO_BUFFER_SIZE, uint32_t flags = 0,
+               allocator *alloc = nullptr, page_codec *codec = nullptr);
+
+        // With BITIO_PADDED, reads past the end of the data return zero bits and set overrun() instead of throwing,
+        // and the page buffer is over-allocated so that reads near its end need no bounds checks. Streaming and
+        // compressed streams ignore the flag.
+        stream(FILE *file, uint64_t buffer_size = BITIO_BUFFER_SIZE, uint32_t flags = 0, allocator *alloc = nullptr);
 
-        stream(FILE *file, uint64_t buffer_size = BITIO_BUFFER_SIZE);
+        // Pages are pulled and pushed with sgetn()/sputn() and positioned with pubseekpos(), so they are copied
+        // straight out of and into the get/put area of the buffer. Non-seekable buffers need the streaming flags.
+        // The streambuf is not owned and must outlive the stream.
+        stream(std::streambuf *buffer, uint64_t buffer_size = BITIO_BUFFER_SIZE, uint32_t flags = 0,
+               allocator *alloc = nullptr);
 
         stream(uint8_t *raw, uint64_t buffer_size);
 
+        stream(const stream &) = delete;
+
+        stream(stream &&other) noexcept;
+
+        stream &operator=(const stream &) = delete;
+
+        stream &operator=(stream &&other) noexcept;
+
         ~stream();
 
         uint64_t read(uint8_t n);
 
+        // Like read(), but returns nothing and leaves the cursor alone when fewer than n bits are left. Streaming
+        // input can only find its end by reading, so there a failed read may still move the cursor.
+        [[nodiscard]] std::optional<uint64_t> try_read(uint8_t n);
+
+        // True once a read in BITIO_PADDED mode went past the end of the data. Decoders can check this once per
+        // block instead of handling EOF on every read.
+        [[nodiscard]] bool overrun() const;
+
         void write(uint64_t obj, uint8_t n);
 
+        // Writes length copies of bit. Whole bytes are filled with memset straight into the pages.
+        void write_run(bool bit, uint64_t length);
+
+        // Skips over the bits equal to bit at the cursor, at most limit of them, and returns how many there were.
+        // The cursor stops on the first differing bit or at the end of the data. Whole words are scanned at a
+        // time.
+        uint64_t read_run(bool bit, uint64_t limit = UINT64_MAX);
+
+        // Unary code: value zeros followed by a one.
+        void write_unary(uint64_t value);
+
+        uint64_t read_unary();
+
         void seek(int64_t n);
 
         void seek_to(uint64_t n);
 
+        // Bit offset of the cursor.
+        [[nodiscard]] uint64_t position() const;
+
         [[nodiscard]] uint64_t size();
 
         void flush();
 
+        // True when the stream bypasses the page cache (BITIO_DIRECT_IO was requested and is supported).
+        [[nodiscard]] bool direct() const;
+
+        // CRC32C of the whole stream. With BITIO_CHECKSUM, pages that were already loaded or committed are not
+        // read again.
+        [[nodiscard]] uint32_t checksum();
+
+        // CRC32C of nbits starting at bit offset, packed MSB-first with the last byte zero padded.
+        [[nodiscard]] uint32_t checksum(uint64_t offset, uint64_t nbits);
+
+        [[nodiscard]] std::vector<uint32_t> page_checksums();
+
+        // Pages loaded from now on are checked against these and throw on a mismatch.
+        void verify_checksums(const std::vector<uint32_t> &expected);
+
+        [[nodiscard]] const stream_stats &stats() const;
+
+        // Logs every read, write, seek, seek_to and flush to the recorder until trace(nullptr) is called.
+        void trace(trace_recorder *recorder);
+
+        // Reserves disk space for the first nbytes of a file-backed stream with fallocate(), so that a large
+        // output is laid out contiguously; the file size does not change. The unused part of the reservation is
+        // given back when the stream is closed. Returns false when the stream or the filesystem cannot do it.
+        bool preallocate(uint64_t nbytes);
+
+        // Makes nbits the logical length of a file-backed stream: the bits after it in the last byte are cleared
+        // and the file is cut to the last byte on the next flush(). Writes past the end extend it again.
+        void truncate(uint64_t nbits);
+
     };
+
+    // Copies nbits from src at bit src_offset to dst at bit dst_offset. Both cursors end up past their ranges.
+    void copy_bits(stream &src, uint64_t src_offset, stream &dst, uint64_t dst_offset, uint64_t nbits);
+
+    // Moves nbits within a stream, the ranges may overlap.
+    void move_bits(stream &s, uint64_t from, uint64_t to, uint64_t nbits);
 }
 
 #endif
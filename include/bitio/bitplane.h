@@ -0,0 +1,21 @@
+#ifndef BITIO_BITPLANE_H
+#define BITIO_BITPLANE_H
+
+#include <bitio/bitio.h>
+
+#define BITIO_BITPLANE_BLOCK_SIZE 0x40
+
+namespace bitio {
+    // Bit-plane layout: values are split into blocks of block (64, 128 or 256) values, and every block is stored
+    // as its width planes from the most significant down, plane k holding bit k of each value in order. The last
+    // block may be shorter, its planes are as long as it is. Values are transposed with 64x64 bit-matrix
+    // kernels (8x8 for widths up to 8) and the planes are spliced into the stream in bulk.
+    void write_bitplanes(stream &s, const uint64_t *values, uint64_t count, uint8_t width,
+                         uint16_t block = BITIO_BITPLANE_BLOCK_SIZE);
+
+    // Reads count values written by write_bitplanes() with the same width and block size from the cursor.
+    void read_bitplanes(stream &s, uint64_t *values, uint64_t count, uint8_t width,
+                        uint16_t block = BITIO_BITPLANE_BLOCK_SIZE);
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef BITIO_BITS_H
+#define BITIO_BITS_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace bitio {
+    inline uint64_t load_be64(const uint8_t *p) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        if constexpr (std::endian::native == std::endian::little) {
+            v = __builtin_bswap64(v);
+        }
+        return v;
+    }
+
+    inline void store_be64(uint8_t *p, uint64_t v) {
+        if constexpr (std::endian::native == std::endian::little) {
+            v = __builtin_bswap64(v);
+        }
+        std::memcpy(p, &v, 8);
+    }
+
+    // Shifts a big-endian bit string of n bytes left by 0 < shift < 8 bits, pulling in the top bits of next.
+    inline void funnel_shift(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift) {
+        uint64_t i = 0;
+        for (; i + 8 < n; i += 8) {
+            store_be64(p + i, (load_be64(p + i) << shift) | (p[i + 8] >> (8 - shift)));
+        }
+
+        for (; i + 1 < n; i++) {
+            p[i] = (p[i] << shift) | (p[i + 1] >> (8 - shift));
+        }
+
+        if (i < n) {
+            p[i] = (p[i] << shift) | (next >> (8 - shift));
+        }
+    }
+
+    inline uint64_t low_mask(uint8_t n) {
+        return n >= 0x40 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+    }
+
+    // Reads n <= 64 bits at bit offset position of a big-endian bit string. Up to 9 bytes are loaded, so the
+    // buffer needs 8 bytes of padding past the last bit.
+    inline uint64_t extract_bits(const uint8_t *p, uint64_t position, uint8_t n) {
+        const uint8_t *q = p + (position >> 3);
+        uint8_t shift = position & 0x7;
+
+        uint64_t word = load_be64(q) << shift;
+        if (shift + n > 0x40) {
+            word |= q[8] >> (8 - shift);
+        }
+        return word >> (0x40 - n);
+    }
+
+    // Appends values MSB-first to a byte buffer a word at a time. finish() stores the last partial word, so
+    // the buffer needs 8 bytes of padding.
+    class bit_packer {
+    private:
+        uint8_t *_begin;
+        uint8_t *_out;
+        uint64_t _acc{};
+        uint8_t _fill{};
+
+    public:
+        explicit bit_packer(uint8_t *out) : _begin(out), _out(out) {}
+
+        // value must fit in n bits.
+        inline void put(uint64_t value, uint8_t n) {
+            if (_fill + n < 0x40) {
+                _acc = (_acc << n) | value;
+                _fill += n;
+                return;
+            }
+
+            uint8_t spill = _fill + n - 0x40;
+            _acc = (_fill ? _acc << (0x40 - _fill) : 0) | (value >> spill);
+            store_be64(_out, _acc);
+            _out += 8;
+
+            _acc = value & low_mask(spill);
+            _fill = spill;
+        }
+
+        // Bits written so far.
+        [[nodiscard]] inline uint64_t size() const {
+            return (_out - _begin) * 8 + _fill;
+        }
+
+        inline void finish() {
+            if (_fill) {
+                store_be64(_out, _acc << (0x40 - _fill));
+            }
+        }
+    };
+}
+
+#endif
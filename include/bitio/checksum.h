@@ -0,0 +1,14 @@
+#ifndef BITIO_CHECKSUM_H
+#define BITIO_CHECKSUM_H
+
+#include <cstdint>
+
+namespace bitio {
+    // CRC32C (Castagnoli). Pass the previous result as crc to continue a running checksum.
+    uint32_t crc32c(uint32_t crc, const uint8_t *data, uint64_t n);
+
+    // Checksum of A followed by B, given crc(A), crc(B) and the length of B in bytes.
+    uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef BITIO_CPU_H
+#define BITIO_CPU_H
+
+#include <cstdint>
+
+namespace bitio {
+    // Instruction set levels, roughly the x86-64 microarchitecture levels: sse42 adds SSE4.2 and popcnt, avx2
+    // adds AVX2, BMI1 and BMI2, avx512 adds AVX-512 F/BW/VL. Other architectures always run the scalar kernels.
+    enum class cpu_level : uint8_t {
+        scalar = 0,
+        sse42 = 1,
+        avx2 = 2,
+        avx512 = 3
+    };
+
+    // Bulk kernels behind the stream helpers. Every level has a complete table; kernels without a faster
+    // version at some level use the best one below it.
+    struct kernel_table {
+        uint32_t (*crc32c)(uint32_t crc, const uint8_t *data, uint64_t n);
+
+        uint64_t (*extract_mask)(uint64_t value, uint64_t mask);
+
+        uint64_t (*deposit_mask)(uint64_t value, uint64_t mask);
+
+        void (*morton2_encode)(const uint32_t *x, const uint32_t *y, uint64_t *codes, uint64_t n);
+
+        void (*morton2_decode)(const uint64_t *codes, uint32_t *x, uint32_t *y, uint64_t n);
+
+        void (*morton3_encode)(const uint32_t *x, const uint32_t *y, const uint32_t *z, uint64_t *codes, uint64_t n);
+
+        void (*morton3_decode)(const uint64_t *codes, uint32_t *x, uint32_t *y, uint32_t *z, uint64_t n);
+
+        // See funnel_shift() in bits.h.
+        void (*funnel_shift)(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift);
+
+        uint64_t (*popcount)(const uint64_t *words, uint64_t n);
+
+        // Transposes a 64x64 bit matrix in place, bit j of row i (MSB first) becomes bit i of row j.
+        void (*transpose64)(uint64_t *rows);
+    };
+
+    // Highest level supported by the CPU and the operating system, detected once.
+    cpu_level detected_cpu_level();
+
+    // Level in use: the detected one, or BITIO_CPU_LEVEL (scalar, sse42, avx2 or avx512) from the environment
+    // when that is lower.
+    cpu_level active_cpu_level();
+
+    // Switches all kernels to another level, capped at the detected one. Meant for tests and benchmarks; calls
+    // racing with kernels on other threads see either table.
+    void set_cpu_level(cpu_level level);
+
+    const char *cpu_level_name(cpu_level level);
+
+    const kernel_table &kernels();
+
+    const kernel_table &kernels(cpu_level level);
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef BITIO_INT_CODEC_H
+#define BITIO_INT_CODEC_H
+
+#include <bitio/bitio.h>
+#include <vector>
+
+#define BITIO_INT_BLOCK_SIZE 0x80
+
+namespace bitio {
+    enum class int_encoding : uint8_t {
+        // Zigzag encoded differences to the previous value, for slowly changing series.
+        delta = 0,
+        // Offsets from the block minimum at a per-block bit width.
+        frame_of_reference = 1,
+        // Frame of reference sized for most of the block, the high bits of outliers are stored separately.
+        patched = 2,
+        // Whichever of the above is smallest, chosen per block.
+        best = 3
+    };
+
+    // Writes an integer array at the cursor as a 64-bit count followed by blocks of up to 128 values. Every block
+    // starts with a header naming its encoding and bit width, so readers need no out-of-band information and
+    // blocks with different encodings can be mixed. Signed values round trip through their two's complement.
+    void write_ints(stream &s, const uint64_t *values, uint64_t n, int_encoding encoding = int_encoding::best);
+
+    // Reads an array written by write_ints() from the cursor.
+    std::vector<uint64_t> read_ints(stream &s);
+}
+
+#endif
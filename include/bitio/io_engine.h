@@ -0,0 +1,115 @@
+#ifndef BITIO_IO_ENGINE_H
+#define BITIO_IO_ENGINE_H
+
+#include <bitio/async.h>
+#include <memory>
+#include <unordered_map>
+
+#define BITIO_ENGINE_QUEUE_DEPTH 0x40
+#define BITIO_ENGINE_THREADS 0x4
+
+#define BITIO_ENGINE_NO_URING 0x1
+
+namespace bitio {
+    // Shared page I/O for many file streams. Page loads and write-backs requested through the executor interface
+    // are queued and handed to the kernel together on the next poll() or wait(), as one io_uring submission
+    // where available and through a small thread pool otherwise. At most queue_depth transfers are in flight,
+    // the rest wait in the queue.
+    //
+    // Attached streams keep working synchronously (with pread/pwrite), but each of them may only have a single
+    // request in flight, so one coroutine should drive one stream. The engine is not thread-safe and all its
+    // coroutines are resumed on the thread calling poll()/wait().
+    class io_engine : public executor {
+    private:
+        struct ring;
+
+        struct request {
+            stream *s{};
+            completion job;
+            std::coroutine_handle<> handle;
+
+            int fd{-1};
+            uint8_t *buffer{};
+            uint64_t page{};
+            uint64_t write_position{};
+            uint64_t write_length{};
+            int64_t write_result{};
+            uint64_t read_position{};
+            uint64_t read_length{};
+            int64_t read_result{};
+            uint32_t remaining{};
+            bool load{};
+        };
+
+        std::unique_ptr<ring> _ring;
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _work_cv;
+        std::condition_variable _done_cv;
+        std::deque<request *> _work;
+        std::deque<request *> _done;
+        bool _stop{};
+
+        std::unordered_map<stream *, bool> _streams;
+        std::deque<std::unique_ptr<request>> _queued;
+        std::deque<std::unique_ptr<request>> _completed;
+        std::deque<std::pair<std::function<void()>, std::coroutine_handle<>>> _ready;
+        std::unordered_map<request *, std::unique_ptr<request>> _in_flight;
+        uint32_t _depth;
+        uint32_t _transfers{};
+        uint64_t _flushing{};
+
+        void work();
+
+        void enqueue(stream &s, bool load, uint64_t page, completion job, std::coroutine_handle<> handle);
+
+        void dispatch();
+
+        void reap(bool block);
+
+        void finish(request *r, uint32_t transfers);
+
+        std::exception_ptr complete(std::unique_ptr<request> r, bool resume);
+
+        // Detaches a stream that is being closed or moved without throwing. Its requests are dropped, transfers
+        // already handed out are waited for first, and a failed write-back is ignored.
+        void drop(stream &s);
+
+        friend class stream;
+
+    public:
+        explicit io_engine(uint32_t queue_depth = BITIO_ENGINE_QUEUE_DEPTH, uint32_t flags = 0);
+
+        ~io_engine() override;
+
+        // Only plain file streams can be attached, streaming and compressed streams throw.
+        void attach(stream &s);
+
+        // Writes back the dirty page of the stream, which must not have a request in flight.
+        void detach(stream &s);
+
+        // True when transfers go through io_uring rather than the thread pool.
+        [[nodiscard]] bool uring() const;
+
+        // Jobs without a page run on the polling thread.
+        void submit(std::function<void()> job, std::coroutine_handle<> handle) override;
+
+        void submit_load(stream &s, uint64_t page, completion job, std::coroutine_handle<> handle) override;
+
+        void submit_writeback(stream &s, completion job, std::coroutine_handle<> handle) override;
+
+        // Resumes every coroutine whose I/O has finished and submits everything queued since, returns how many
+        // coroutines were resumed.
+        uint64_t poll();
+
+        // Like poll(), but blocks until at least one coroutine is ready when any I/O is in flight.
+        uint64_t wait();
+
+        [[nodiscard]] uint64_t pending() const;
+
+        // Writes back the dirty pages of all attached streams without a request in flight in one batch.
+        void flush();
+    };
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef BITIO_LANES_H
+#define BITIO_LANES_H
+
+#include <bitio/bitio.h>
+#include <bitio/bits.h>
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#define BITIO_LANE_PADDING 0x10
+
+namespace bitio {
+    // Interleaved layout of Lanes independent bit streams: a 7-bit width w, the size of every lane in bits as a
+    // w-bit number, then the lanes back to back. Decoding one lane is a serial chain of cursor updates; decoding
+    // several in lockstep gives the CPU independent chains to overlap.
+    template<uint8_t Lanes>
+    class lane_writer {
+        static_assert(Lanes == 2 || Lanes == 4 || Lanes == 8, "lane counts must be 2, 4 or 8");
+
+    private:
+        std::vector<uint8_t> _data[Lanes];
+        uint64_t _acc[Lanes]{};
+        uint8_t _fill[Lanes]{};
+        uint64_t _size[Lanes]{};
+
+    public:
+        // Appends the low n bits of value to a lane.
+        inline void write(uint8_t lane, uint64_t value, uint8_t n) {
+            if (n == 0) {
+                return;
+            }
+
+            value &= low_mask(n);
+            _size[lane] += n;
+
+            uint8_t fill = _fill[lane];
+            if (fill + n < 0x40) {
+                _acc[lane] = (_acc[lane] << n) | value;
+                _fill[lane] = fill + n;
+                return;
+            }
+
+            uint8_t spill = fill + n - 0x40;
+            auto &data = _data[lane];
+            data.resize(data.size() + 8);
+            store_be64(data.data() + data.size() - 8, (fill ? _acc[lane] << (0x40 - fill) : 0) | (value >> spill));
+
+            _acc[lane] = value & low_mask(spill);
+            _fill[lane] = spill;
+        }
+
+        // Appends values[i] to lane i, n bits each.
+        inline void write_all(const uint64_t *values, uint8_t n) {
+            for (uint8_t lane = 0; lane < Lanes; lane++) {
+                write(lane, values[lane], n);
+            }
+        }
+
+        [[nodiscard]] uint64_t size(uint8_t lane) const {
+            return _size[lane];
+        }
+
+        // Writes the header and all lanes at the cursor of s, and starts over with empty lanes.
+        void finish(stream &s) {
+            uint8_t width = 0;
+            for (uint8_t lane = 0; lane < Lanes; lane++) {
+                width = std::max<uint8_t>(width, std::bit_width(_size[lane]));
+            }
+
+            s.write(width, 7);
+            for (uint8_t lane = 0; lane < Lanes; lane++) {
+                s.write(_size[lane], width);
+            }
+
+            for (uint8_t lane = 0; lane < Lanes; lane++) {
+                auto &data = _data[lane];
+                if (_fill[lane]) {
+                    data.resize(data.size() + 8);
+                    store_be64(data.data() + data.size() - 8, _acc[lane] << (0x40 - _fill[lane]));
+                }
+
+                if (_size[lane]) {
+                    stream source(data.data(), data.size());
+                    copy_bits(source, 0, s, s.position(), _size[lane]);
+                }
+
+                data.clear();
+                _acc[lane] = 0;
+                _fill[lane] = 0;
+                _size[lane] = 0;
+            }
+        }
+    };
+
+    // Reads a layout written by lane_writer. The lanes are copied into memory with some padding, and every read
+    // is a clamped load from the lane's own cursor, so reads past the end of a lane never fault. They return
+    // unspecified bits instead, which overrun() reports; check it once per block rather than per read.
+    template<uint8_t Lanes>
+    class lane_reader {
+        static_assert(Lanes == 2 || Lanes == 4 || Lanes == 8, "lane counts must be 2, 4 or 8");
+
+    private:
+        std::vector<uint8_t> _data;
+        uint64_t _position[Lanes]{};
+        uint64_t _end[Lanes]{};
+        uint64_t _limit{};
+
+        [[nodiscard]] inline uint64_t load(uint64_t position, uint8_t n) const {
+            position = std::min(position, _limit);
+            const uint8_t *p = _data.data() + (position >> 3);
+            uint8_t shift = position & 0x7;
+            uint64_t word = (load_be64(p) << shift) | (uint64_t(p[8]) >> (8 - shift));
+            return word >> (0x40 - n);
+        }
+
+    public:
+        // Reads the header and the lanes from the cursor of s, which is left after the last lane.
+        explicit lane_reader(stream &s) {
+            uint8_t width = s.read(7);
+            uint64_t total = 0;
+            for (uint8_t lane = 0; lane < Lanes; lane++) {
+                _position[lane] = total;
+                total += s.read(width);
+                _end[lane] = total;
+            }
+
+            _limit = total;
+            _data.resize(((total + 7) >> 3) + BITIO_LANE_PADDING);
+            if (total) {
+                stream target(_data.data(), _data.size());
+                copy_bits(s, s.position(), target, 0, total);
+            }
+        }
+
+        // Reads n <= 64 bits from a lane.
+        inline uint64_t read(uint8_t lane, uint8_t n) {
+            if (n == 0) {
+                return 0;
+            }
+
+            uint64_t value = load(_position[lane], n);
+            _position[lane] += n;
+            return value;
+        }
+
+        // Reads n bits from every lane into values[lane]. The loop has no branches, so the lanes decode in
+        // parallel and the compiler is free to vectorize it.
+        inline void read_all(uint64_t *values, uint8_t n) {
+            if (n == 0) {
+                std::fill(values, values + Lanes, 0);
+                return;
+            }
+
+            for (uint8_t lane = 0; lane < Lanes; lane++) {
+                values[lane] = load(_position[lane], n);
+                _position[lane] += n;
+            }
+        }
+
+        // The next n bits of a lane without consuming them, for table driven decoders.
+        [[nodiscard]] inline uint64_t peek(uint8_t lane, uint8_t n) const {
+            return n ? load(_position[lane], n) : 0;
+        }
+
+        inline void skip(uint8_t lane, uint64_t n) {
+            _position[lane] += n;
+        }
+
+        // Bits left in a lane.
+        [[nodiscard]] uint64_t remaining(uint8_t lane) const {
+            return _position[lane] < _end[lane] ? _end[lane] - _position[lane] : 0;
+        }
+
+        // True once any lane was read past its end.
+        [[nodiscard]] bool overrun() const {
+            bool over = false;
+            for (uint8_t lane = 0; lane < Lanes; lane++) {
+                over |= _position[lane] > _end[lane];
+            }
+            return over;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef BITIO_MORTON_H
+#define BITIO_MORTON_H
+
+#include <bitio/bitio.h>
+
+namespace bitio {
+    // Gathers the bits of value selected by mask into the low bits of the result (x86 BMI2 pext).
+    uint64_t extract_mask(uint64_t value, uint64_t mask);
+
+    // Scatters the low bits of value to the positions set in mask (x86 BMI2 pdep).
+    uint64_t deposit_mask(uint64_t value, uint64_t mask);
+
+    // Reads n bits and returns the ones selected by mask, packed. Bit 0 of the mask is the last bit read.
+    uint64_t read_extract(stream &s, uint8_t n, uint64_t mask);
+
+    // Writes the low bits of value to the positions set in mask of an n-bit field, the other bits are zero.
+    void write_deposit(stream &s, uint64_t value, uint64_t mask, uint8_t n);
+
+    // Z-order codes: bit i of x goes to bit 2i (3i in 3D), y and z follow. 3D coordinates keep 21 bits.
+    uint64_t morton2_encode(uint32_t x, uint32_t y);
+
+    void morton2_decode(uint64_t code, uint32_t &x, uint32_t &y);
+
+    uint64_t morton3_encode(uint32_t x, uint32_t y, uint32_t z);
+
+    void morton3_decode(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z);
+
+    // Bulk versions over n elements.
+    void morton2_encode(const uint32_t *x, const uint32_t *y, uint64_t *codes, uint64_t n);
+
+    void morton2_decode(const uint64_t *codes, uint32_t *x, uint32_t *y, uint64_t n);
+
+    void morton3_encode(const uint32_t *x, const uint32_t *y, const uint32_t *z, uint64_t *codes, uint64_t n);
+
+    void morton3_decode(const uint64_t *codes, uint32_t *x, uint32_t *y, uint32_t *z, uint64_t n);
+}
+
+#endif
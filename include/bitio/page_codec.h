@@ -0,0 +1,26 @@
+#ifndef BITIO_PAGE_CODEC_H
+#define BITIO_PAGE_CODEC_H
+
+#include <cstdint>
+
+namespace bitio {
+    // Transform applied to each page of a compressed stream. Pages are encoded independently.
+    class page_codec {
+    public:
+        virtual ~page_codec() = default;
+
+        // Upper bound of the encoded size of n bytes.
+        [[nodiscard]] virtual uint64_t bound(uint64_t n) const = 0;
+
+        virtual uint64_t encode(const uint8_t *in, uint64_t n, uint8_t *out) const = 0;
+
+        // Decodes exactly raw bytes into out, throws bitio_exception on malformed input.
+        virtual void decode(const uint8_t *in, uint64_t n, uint8_t *out, uint64_t raw) const = 0;
+    };
+
+    // Byte run-length codec. Runs of four or more equal bytes (zero runs in sparse bitmaps, all-ones flag words)
+    // collapse to a few bytes, everything else is copied as literals.
+    page_codec *rle_codec();
+}
+
+#endif
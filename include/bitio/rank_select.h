@@ -0,0 +1,59 @@
+#ifndef BITIO_RANK_SELECT_H
+#define BITIO_RANK_SELECT_H
+
+#include <bitio/bitio.h>
+#include <vector>
+
+#define BITIO_RS_BLOCK_BITS 0x200
+#define BITIO_RS_SUPERBLOCK_BITS 0x1000
+#define BITIO_RS_SELECT_SAMPLE 0x1000
+
+namespace bitio {
+    // Rank/select index over a bit range of a stream. Every 4096-bit superblock keeps an absolute count and
+    // every 512-bit block a 16-bit count relative to its superblock, which is ~4.7% on top of the bitmap.
+    class rank_select {
+    private:
+        std::vector<uint64_t> _words;
+        std::vector<uint64_t> _superblocks;
+        std::vector<uint16_t> _blocks;
+        std::vector<uint64_t> _select_samples;
+
+        uint64_t _size{};
+        uint64_t _ones{};
+
+        void read_words(stream &s, uint64_t offset);
+
+        void build_samples();
+
+        [[nodiscard]] inline uint64_t zeros_before_superblock(uint64_t sb) const;
+
+    public:
+        rank_select() = default;
+
+        rank_select(stream &s, uint64_t offset, uint64_t nbits);
+
+        // Number of ones in [0, i).
+        [[nodiscard]] uint64_t rank1(uint64_t i) const;
+
+        [[nodiscard]] uint64_t rank0(uint64_t i) const;
+
+        // Position of the k-th one (zero based).
+        [[nodiscard]] uint64_t select1(uint64_t k) const;
+
+        [[nodiscard]] uint64_t select0(uint64_t k) const;
+
+        [[nodiscard]] bool access(uint64_t i) const;
+
+        [[nodiscard]] uint64_t size() const;
+
+        [[nodiscard]] uint64_t ones() const;
+
+        // Writes the index (not the bitmap) at the current position of the stream.
+        void store(stream &s) const;
+
+        // Reads an index written by store() from the current position and the bitmap from offset.
+        static rank_select load(stream &s, uint64_t offset);
+    };
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef BITIO_RECORD_H
+#define BITIO_RECORD_H
+
+#include <bitio/bitio.h>
+#include <bitio/bits.h>
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#define BITIO_RECORD_BATCH_SIZE 0x1000
+
+namespace bitio {
+    template<typename T>
+    struct member_pointer_traits;
+
+    template<typename C, typename M>
+    struct member_pointer_traits<M C::*> {
+        using class_type = C;
+        using member_type = M;
+    };
+
+    // One bit field of a record: the data member it maps to and its width. Signed members are sign extended
+    // when read back.
+    template<auto Member, uint8_t Width>
+    struct field {
+        static_assert(Width > 0 && Width <= 0x40, "field widths must be between 1 and 64 bits");
+
+        using member_type = typename member_pointer_traits<decltype(Member)>::member_type;
+
+        static constexpr auto member = Member;
+        static constexpr uint8_t width = Width;
+    };
+
+    // Fixed sequence of bit fields, stored MSB-first in declaration order, e.g.
+    //
+    //     using header_schema = bitio::schema<bitio::field<&header::type, 3>, bitio::field<&header::length, 12>>;
+    //
+    // Neighbouring fields are grouped into chunks of up to 64 bits at compile time and every chunk is moved with
+    // a single read() or write(). The bulk functions pack whole batches of records in memory and splice them in
+    // with copy_bits().
+    template<typename... Fields>
+    class schema {
+    private:
+        using fields = std::tuple<Fields...>;
+
+        static constexpr std::array<uint8_t, sizeof...(Fields)> _widths{Fields::width...};
+
+        // Size of the chunk starting at field i, zero when the field continues the previous chunk.
+        static constexpr uint8_t chunk_size(size_t i) {
+            uint32_t fill = 0;
+            bool start = true;
+            for (size_t j = 0; j <= i; j++) {
+                start = fill == 0 || fill + _widths[j] > 0x40;
+                fill = start ? _widths[j] : fill + _widths[j];
+            }
+
+            if (!start) {
+                return 0;
+            }
+
+            uint32_t size = 0;
+            for (size_t j = i; j < _widths.size() && size + _widths[j] <= 0x40; j++) {
+                size += _widths[j];
+            }
+            return size;
+        }
+
+        template<typename F, typename T>
+        static inline uint64_t get(const T &record) {
+            return static_cast<uint64_t>(record.*F::member) & low_mask(F::width);
+        }
+
+        template<typename F, typename T>
+        static inline void set(T &record, uint64_t value) {
+            using M = typename F::member_type;
+            if constexpr (std::is_signed_v<M> && F::width < 0x40) {
+                uint64_t sign = uint64_t(1) << (F::width - 1);
+                value = (value ^ sign) - sign;
+            }
+            record.*F::member = static_cast<M>(value);
+        }
+
+        template<typename T, size_t... I>
+        static inline void write_fields(stream &s, const T &record, std::index_sequence<I...>) {
+            uint64_t chunk = 0;
+            uint8_t fill = 0;
+
+            ([&]() {
+                using F = std::tuple_element_t<I, fields>;
+                chunk = fill ? (chunk << F::width) | get<F>(record) : get<F>(record);
+                fill += F::width;
+
+                if constexpr (I + 1 == sizeof...(Fields) || chunk_size(I + 1) != 0) {
+                    s.write(chunk, fill);
+                    fill = 0;
+                }
+            }(), ...);
+        }
+
+        template<typename T, size_t... I>
+        static inline void read_fields(stream &s, T &record, std::index_sequence<I...>) {
+            uint64_t chunk = 0;
+            uint8_t left = 0;
+
+            ([&]() {
+                using F = std::tuple_element_t<I, fields>;
+                if constexpr (chunk_size(I) != 0) {
+                    chunk = s.read(chunk_size(I));
+                    left = chunk_size(I);
+                }
+
+                left -= F::width;
+                set<F>(record, (chunk >> left) & low_mask(F::width));
+            }(), ...);
+        }
+
+        static constexpr uint64_t batch_records = std::max<uint64_t>(1, BITIO_RECORD_BATCH_SIZE * 8 / (
+                (uint64_t(Fields::width) + ...)));
+
+        static constexpr uint64_t batch_bytes = (batch_records * (uint64_t(Fields::width) + ...) + 7) / 8 + 16;
+
+    public:
+        // Record size in bits.
+        static constexpr uint64_t bits = (uint64_t(Fields::width) + ...);
+
+        template<typename T>
+        static void write(stream &s, const T &record) {
+            write_fields(s, record, std::index_sequence_for<Fields...>{});
+        }
+
+        template<typename T>
+        static void read(stream &s, T &record) {
+            read_fields(s, record, std::index_sequence_for<Fields...>{});
+        }
+
+        template<typename T>
+        static T read(stream &s) {
+            T record{};
+            read(s, record);
+            return record;
+        }
+
+        template<typename T>
+        static void write_all(stream &s, const T *records, uint64_t n) {
+            uint8_t buffer[batch_bytes];
+            uint64_t position = s.position();
+
+            while (n) {
+                uint64_t m = std::min(n, batch_records);
+
+                bit_packer packer(buffer);
+                for (uint64_t i = 0; i < m; i++) {
+                    (packer.put(get<Fields>(records[i]), Fields::width), ...);
+                }
+                packer.finish();
+
+                stream batch(buffer, batch_bytes);
+                copy_bits(batch, 0, s, position, m * bits);
+
+                position += m * bits;
+                records += m;
+                n -= m;
+            }
+        }
+
+        template<typename T>
+        static void read_all(stream &s, T *records, uint64_t n) {
+            // Zeroed, since copy_bits() merges into the partial last byte and extract_bits() loads past the data.
+            uint8_t buffer[batch_bytes]{};
+            uint64_t position = s.position();
+
+            while (n) {
+                uint64_t m = std::min(n, batch_records);
+
+                stream batch(buffer, batch_bytes);
+                copy_bits(s, position, batch, 0, m * bits);
+
+                uint64_t offset = 0;
+                for (uint64_t i = 0; i < m; i++) {
+                    ((set<Fields>(records[i], extract_bits(buffer, offset, Fields::width)),
+                            offset += Fields::width), ...);
+                }
+
+                position += m * bits;
+                records += m;
+                n -= m;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef BITIO_REVERSE_WRITER_H
+#define BITIO_REVERSE_WRITER_H
+
+#include <bitio/bitio.h>
+#include <vector>
+
+#define BITIO_REVERSE_BLOCK_SIZE 0x1000
+
+namespace bitio {
+    // Writes a stream back to front, for encoders (rANS and the like) that produce their output in reverse.
+    // Every write() goes in front of everything written before, so reading the result forwards returns the
+    // values in the opposite order, each with its bits in the usual MSB-first order. Whole words are staged in a
+    // block that is filled from its end and copied to the stream once full.
+    class reverse_writer {
+    private:
+        stream *_stream;
+        std::vector<uint8_t> _block;
+        uint64_t _block_head;
+        uint64_t _end;
+        uint64_t _acc{};
+        uint8_t _fill{};
+        uint64_t _size{};
+        bool _finished{};
+
+        void flush_block();
+
+    public:
+        // The data ends at bit end of s, which must be byte aligned, and grows toward the start of the stream.
+        reverse_writer(stream &s, uint64_t end);
+
+        reverse_writer(const reverse_writer &) = delete;
+
+        // Prepends the low n bits of value.
+        void write(uint64_t value, uint8_t n);
+
+        // Bits written so far.
+        [[nodiscard]] uint64_t size() const;
+
+        // Writes out what is left and returns the bit offset where the data starts. The cursor of the stream is
+        // left there, ready to read() forwards. The writer is done after that, further write() and finish() calls
+        // throw.
+        uint64_t finish();
+
+        // Like finish(), but moves the data to bit offset to first. Returns the size in bits.
+        uint64_t finish(uint64_t to);
+    };
+}
+
+#endif
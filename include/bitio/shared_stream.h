@@ -0,0 +1,70 @@
+#ifndef BITIO_SHARED_STREAM_H
+#define BITIO_SHARED_STREAM_H
+
+#include <bitio/bitio.h>
+#include <bitio/bit_view.h>
+
+#define BITIO_SHARED_MAGIC 0x424954494f53484dull
+
+namespace bitio {
+    // Fixed-capacity stream in a memfd mapping shared between processes. The producer writes through stream()
+    // and publish()es how many bits are complete; consumers map the same file descriptor (inherited, passed
+    // over a unix socket or opened through /proc/<pid>/fd) and read the published range in place. The watermark
+    // is stored with release and loaded with acquire semantics, so everything below it is visible to readers.
+    class shared_stream {
+    private:
+        struct header;
+
+        int _fd{-1};
+        uint8_t *_mapping{};
+        uint64_t _mapping_size{};
+        header *_header{};
+        bitio::stream _stream;
+
+        void map(int fd, uint64_t size);
+
+        void release();
+
+        shared_stream() = default;
+
+    public:
+        // Creates a new region holding capacity bytes, name only shows up in /proc.
+        static shared_stream create(uint64_t capacity, const std::string &name = "bitio");
+
+        // Maps the region behind fd, which is duplicated and can be closed by the caller.
+        static shared_stream open(int fd);
+
+        shared_stream(const shared_stream &) = delete;
+
+        shared_stream(shared_stream &&other) noexcept;
+
+        shared_stream &operator=(const shared_stream &) = delete;
+
+        shared_stream &operator=(shared_stream &&other) noexcept;
+
+        ~shared_stream();
+
+        [[nodiscard]] int fd() const;
+
+        [[nodiscard]] uint64_t capacity() const;
+
+        // In-memory stream over the shared bytes.
+        [[nodiscard]] bitio::stream &stream();
+
+        // Publishes everything before the cursor of stream().
+        void publish();
+
+        // Publishes the first nbits, the watermark never moves backwards.
+        void publish(uint64_t nbits);
+
+        [[nodiscard]] uint64_t watermark() const;
+
+        // Blocks until at least nbits are published, returns the watermark.
+        uint64_t wait(uint64_t nbits) const;
+
+        // Bounded view of the published bits as of now.
+        [[nodiscard]] bit_view published();
+    };
+}
+
+#endif
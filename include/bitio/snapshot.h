@@ -0,0 +1,82 @@
+#ifndef BITIO_SNAPSHOT_H
+#define BITIO_SNAPSHOT_H
+
+#include <bitio/bitio.h>
+#include <memory>
+#include <vector>
+
+#define BITIO_COW_PAGE_SIZE 0x1000
+
+namespace bitio {
+    // Immutable image of a cow_stream. Copies share the image and only carry their own cursor, so every reader
+    // thread takes its own copy and reads without any locking.
+    class snapshot {
+    private:
+        struct image {
+            std::vector<std::shared_ptr<uint8_t[]>> pages;
+            uint64_t page_size;
+            uint64_t size;
+        };
+
+        std::shared_ptr<const image> _image;
+        uint64_t _position{};
+
+        friend class cow_stream;
+
+    public:
+        snapshot() = default;
+
+        uint64_t read(uint8_t n);
+
+        void seek(int64_t n);
+
+        void seek_to(uint64_t n);
+
+        [[nodiscard]] uint64_t position() const;
+
+        // Size in bits.
+        [[nodiscard]] uint64_t size() const;
+    };
+
+    // In-memory stream made of reference counted pages. snapshot() shares the pages written so far and the
+    // writer copies a page before it next modifies one that is still shared, so taking a snapshot costs a
+    // pointer per page plus at most one page copy for the page being appended to.
+    class cow_stream {
+    private:
+        std::vector<std::shared_ptr<uint8_t[]>> _pages;
+        allocator *_allocator;
+        uint64_t _page_size;
+        uint64_t _position{};
+        uint64_t _size{};
+
+        // Page the writer is known to own exclusively.
+        uint64_t _owned_page{UINT64_MAX};
+        uint8_t *_owned{};
+
+        std::shared_ptr<uint8_t[]> allocate_page(const uint8_t *source);
+
+        uint8_t *writable_byte(uint64_t offset);
+
+    public:
+        explicit cow_stream(uint64_t page_size = BITIO_COW_PAGE_SIZE, allocator *alloc = nullptr);
+
+        uint64_t read(uint8_t n);
+
+        void write(uint64_t obj, uint8_t n);
+
+        void seek(int64_t n);
+
+        void seek_to(uint64_t n);
+
+        [[nodiscard]] uint64_t position() const;
+
+        // Bits written so far.
+        [[nodiscard]] uint64_t size() const;
+
+        // Captures everything written so far. Must be called on the writing thread, the result can then be handed
+        // to any number of readers.
+        [[nodiscard]] bitio::snapshot snapshot();
+    };
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef BITIO_STREAMBUF_H
+#define BITIO_STREAMBUF_H
+
+#include <bitio/bitio.h>
+#include <streambuf>
+#include <vector>
+
+#define BITIO_STREAMBUF_PUT_SIZE 0x1000
+
+namespace bitio {
+    // std::streambuf over the bytes of a stream from its (byte aligned) cursor on, for std::istream/std::ostream
+    // consumers. The get area is the page cache of the stream itself, so reads copy nothing. Writes collect in a
+    // small put area and large ones go straight into the pages. Positions are relative to where the view
+    // started. The stream must not be used directly while the view is, sync() or destroying the view moves its
+    // cursor past the last byte read or written. Errors of the stream never escape: failed writes show up as
+    // eof or short counts, which set badbit on the iostream.
+    class streambuf : public std::streambuf {
+    private:
+        stream *_stream;
+        uint64_t _begin;
+        uint64_t _offset{};
+        std::vector<char> _put;
+
+        [[nodiscard]] uint64_t current() const;
+
+        uint64_t put(const char *s, uint64_t n);
+
+        bool settle();
+
+    protected:
+        int_type underflow() override;
+
+        int_type overflow(int_type c) override;
+
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+        std::streamsize showmanyc() override;
+
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+        int sync() override;
+
+    public:
+        explicit streambuf(stream &s);
+
+        streambuf(const streambuf &) = delete;
+
+        streambuf &operator=(const streambuf &) = delete;
+
+        ~streambuf() override;
+    };
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef BITIO_TRACE_H
+#define BITIO_TRACE_H
+
+#include <bitio/bitio.h>
+
+namespace bitio {
+    enum class trace_op : uint8_t {
+        read,
+        write,
+        seek,
+        seek_to,
+        flush,
+        begin,
+        end
+    };
+
+    // For read and write the value is the width, for seek the (signed) distance, for seek_to the target and for
+    // begin the size of the traced stream in bytes.
+    struct trace_event {
+        trace_op op;
+        uint64_t value;
+    };
+
+    // Compact log of the operations on a stream, see stream::trace(). Every event is a 3-bit op; widths take 6
+    // more bits and offsets a 7-bit length followed by that many bits, so a trace of single reads costs ~9 bits
+    // per call. Payloads are never recorded.
+    class trace_recorder {
+    private:
+        bitio::stream _stream;
+        uint64_t _events{};
+        bool _closed{};
+
+        void write_value(uint64_t value);
+
+    public:
+        explicit trace_recorder(const std::string &filename);
+
+        trace_recorder(const trace_recorder &) = delete;
+
+        ~trace_recorder();
+
+        void record(trace_op op, uint64_t value);
+
+        [[nodiscard]] uint64_t events() const;
+
+        // Writes the end marker and everything recorded so far, nothing can be recorded afterwards.
+        void close();
+    };
+
+    class trace_reader {
+    private:
+        bitio::stream _stream;
+        bool _done{};
+
+    public:
+        explicit trace_reader(const std::string &filename);
+
+        // Returns false once the end marker was read.
+        bool next(trace_event &event);
+    };
+}
+
+#endif
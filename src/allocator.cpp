@@ -0,0 +1,133 @@
+#include <bitio/allocator.h>
+#include <atomic>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+
+namespace {
+    class heap_allocator_impl : public bitio::allocator {
+    public:
+        uint8_t *allocate(uint64_t size, uint64_t alignment) override {
+            return static_cast<uint8_t *>(::operator new(size, std::align_val_t(alignment)));
+        }
+
+        void deallocate(uint8_t *ptr, uint64_t, uint64_t alignment) override {
+            ::operator delete(ptr, std::align_val_t(alignment));
+        }
+    };
+
+    class hugepage_allocator_impl : public bitio::allocator {
+    private:
+        static uint64_t mapping_size(uint64_t size) {
+            return (size + BITIO_HUGEPAGE_SIZE - 1) & ~uint64_t(BITIO_HUGEPAGE_SIZE - 1);
+        }
+
+    public:
+        uint8_t *allocate(uint64_t size, uint64_t) override {
+            uint64_t length = mapping_size(size);
+            void *ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+            ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+            if (ptr == MAP_FAILED) {
+                ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (ptr == MAP_FAILED) {
+                    throw std::bad_alloc();
+                }
+#ifdef MADV_HUGEPAGE
+                ::madvise(ptr, length, MADV_HUGEPAGE);
+#endif
+            }
+
+            return static_cast<uint8_t *>(ptr);
+        }
+
+        void deallocate(uint8_t *ptr, uint64_t size, uint64_t) override {
+            ::munmap(ptr, mapping_size(size));
+        }
+    };
+
+    struct cached_buffer {
+        uint64_t pool;
+        bitio::allocator *upstream;
+        uint8_t *ptr;
+        uint64_t size;
+        uint64_t alignment;
+    };
+
+    // Buffers still cached when a thread exits go back to their upstream allocator.
+    struct thread_cache {
+        std::vector<cached_buffer> buffers;
+
+        ~thread_cache() {
+            for (auto &b : buffers) {
+                b.upstream->deallocate(b.ptr, b.size, b.alignment);
+            }
+        }
+    };
+
+    thread_local thread_cache cache;
+    std::atomic<uint64_t> next_pool_id{1};
+}
+
+bitio::pool_allocator::pool_allocator(allocator *upstream, uint64_t max_cached) {
+    _upstream = upstream ? upstream : heap_allocator();
+    _max_cached = max_cached;
+    _id = next_pool_id++;
+}
+
+bitio::pool_allocator::~pool_allocator() {
+    auto &buffers = cache.buffers;
+    for (uint64_t i = buffers.size(); i--;) {
+        if (buffers[i].pool == _id) {
+            _upstream->deallocate(buffers[i].ptr, buffers[i].size, buffers[i].alignment);
+            buffers.erase(buffers.begin() + i);
+        }
+    }
+}
+
+uint8_t *bitio::pool_allocator::allocate(uint64_t size, uint64_t alignment) {
+    auto &buffers = cache.buffers;
+    for (uint64_t i = buffers.size(); i--;) {
+        auto &b = buffers[i];
+        if (b.pool == _id && b.size == size && b.alignment == alignment) {
+            uint8_t *ptr = b.ptr;
+            b = buffers.back();
+            buffers.pop_back();
+            return ptr;
+        }
+    }
+
+    return _upstream->allocate(size, alignment);
+}
+
+void bitio::pool_allocator::deallocate(uint8_t *ptr, uint64_t size, uint64_t alignment) {
+    auto &buffers = cache.buffers;
+    uint64_t cached = 0;
+    for (auto &b : buffers) {
+        cached += b.pool == _id;
+    }
+
+    if (cached < _max_cached) {
+        buffers.push_back({_id, _upstream, ptr, size, alignment});
+    } else {
+        _upstream->deallocate(ptr, size, alignment);
+    }
+}
+
+bitio::allocator *bitio::heap_allocator() {
+    // Never destroyed, so streams and thread caches may still release buffers during shutdown.
+    static auto *instance = new heap_allocator_impl();
+    return instance;
+}
+
+bitio::allocator *bitio::hugepage_allocator() {
+    static auto *instance = new hugepage_allocator_impl();
+    return instance;
+}
+
+bitio::allocator *bitio::buffer_pool() {
+    static auto *instance = new pool_allocator();
+    return instance;
+}
@@ -0,0 +1,106 @@
+#include <bitio/async.h>
+
+void bitio::executor::submit_load(stream &, uint64_t, completion job, std::coroutine_handle<> handle) {
+    submit([job = std::move(job)]() { job(nullptr); }, handle);
+}
+
+void bitio::executor::submit_writeback(stream &, completion job, std::coroutine_handle<> handle) {
+    submit([job = std::move(job)]() { job(nullptr); }, handle);
+}
+
+bitio::thread_pool_executor::thread_pool_executor(uint32_t threads, bool resume_inline) {
+    _resume_inline = resume_inline;
+    for (uint32_t i = 0; i < std::max<uint32_t>(threads, 1); i++) {
+        _workers.emplace_back([this]() { work(); });
+    }
+}
+
+bitio::thread_pool_executor::~thread_pool_executor() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _jobs_cv.notify_all();
+
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+void bitio::thread_pool_executor::work() {
+    for (;;) {
+        std::pair<std::function<void()>, std::coroutine_handle<>> job;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobs_cv.wait(lock, [this]() { return _stop || !_jobs.empty(); });
+            if (_jobs.empty()) {
+                return;
+            }
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        job.first();
+
+        if (_resume_inline) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _in_flight--;
+            }
+            job.second.resume();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _in_flight--;
+            _completed.push_back(job.second);
+        }
+        _completed_cv.notify_all();
+    }
+}
+
+void bitio::thread_pool_executor::submit(std::function<void()> job, std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _in_flight++;
+        _jobs.emplace_back(std::move(job), handle);
+    }
+    _jobs_cv.notify_one();
+}
+
+uint64_t bitio::thread_pool_executor::poll() {
+    std::deque<std::coroutine_handle<>> ready;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ready.swap(_completed);
+    }
+
+    for (auto handle : ready) {
+        handle.resume();
+    }
+
+    return ready.size();
+}
+
+uint64_t bitio::thread_pool_executor::wait() {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _completed_cv.wait(lock, [this]() { return !_completed.empty() || _in_flight == 0; });
+    }
+
+    return poll();
+}
+
+uint64_t bitio::thread_pool_executor::pending() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _in_flight + _completed.size();
+}
+
+bitio::async_stream::async_stream(stream &s, executor &ex) : _stream(s), _executor(ex) {}
+
+bitio::stream &bitio::async_stream::sync() {
+    return _stream;
+}
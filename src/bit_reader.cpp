@@ -0,0 +1,119 @@
+#include <bitio/bit_reader.h>
+#include <bitio/bits.h>
+#include <algorithm>
+#include <bit>
+
+bitio::bit_reader::bit_reader(const uint8_t *data, uint64_t nbytes) {
+    _data = data;
+    _bytes = nbytes;
+}
+
+bitio::bit_reader::bit_reader(std::span<const std::byte> data) {
+    _data = reinterpret_cast<const uint8_t *>(data.data());
+    _bytes = data.size();
+}
+
+uint64_t bitio::bit_reader::load(uint64_t position, uint8_t n) const {
+    if (n == 0) {
+        return 0;
+    }
+
+    if (n > 0x40) {
+        throw bitio_exception("read() supports upto 64-bits only");
+    }
+
+    if (n > (_bytes << 3) - std::min(position, _bytes << 3)) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    // Away from the end the 9 bytes holding the value are loaded directly, the tail goes through a padded copy.
+    uint64_t index = position >> 3;
+    if (index + 9 <= _bytes) {
+        return extract_bits(_data, position, n);
+    }
+
+    uint8_t tail[16]{};
+    std::copy(_data + index, _data + _bytes, tail);
+    return extract_bits(tail, position & 0x7, n);
+}
+
+uint64_t bitio::bit_reader::read(uint8_t n) {
+    uint64_t value = load(_position, n);
+    _position += n;
+    return value;
+}
+
+std::optional<uint64_t> bitio::bit_reader::try_read(uint8_t n) {
+    if (n > remaining()) {
+        return std::nullopt;
+    }
+
+    return read(n);
+}
+
+uint64_t bitio::bit_reader::peek(uint8_t n) const {
+    return load(_position, n);
+}
+
+uint64_t bitio::bit_reader::read_run(bool bit, uint64_t limit) {
+    limit = std::min(limit, remaining());
+    uint64_t fill = bit ? UINT64_MAX : 0;
+    uint64_t run = 0;
+
+    // Word-aligned chunks of the run are compared with count-leading-zeros, the last one is masked to the limit.
+    while (run < limit) {
+        uint8_t n = std::min<uint64_t>(0x40, limit - run);
+        uint64_t x = (load(_position + run, n) << (0x40 - n)) ^ fill;
+        x &= ~low_mask(0x40 - n);
+        if (x) {
+            run += std::countl_zero(x);
+            break;
+        }
+        run += n;
+    }
+
+    _position += run;
+    return run;
+}
+
+uint64_t bitio::bit_reader::read_unary() {
+    uint64_t value = read_run(false);
+    read(1);
+    return value;
+}
+
+void bitio::bit_reader::seek(int64_t n) {
+    if (n < 0 && uint64_t(-n) > _position) {
+        throw bitio_exception("SOF reached");
+    }
+
+    seek_to(_position + n);
+}
+
+void bitio::bit_reader::seek_to(uint64_t n) {
+    if (n > size()) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    _position = n;
+}
+
+uint64_t bitio::bit_reader::position() const {
+    return _position;
+}
+
+uint64_t bitio::bit_reader::size() const {
+    return _bytes << 3;
+}
+
+uint64_t bitio::bit_reader::remaining() const {
+    return size() - _position;
+}
+
+bool bitio::bit_reader::eof() const {
+    return _position == size();
+}
+
+const uint8_t *bitio::bit_reader::data() const {
+    return _data;
+}
@@ -0,0 +1,76 @@
+#include <bitio/bit_view.h>
+
+bitio::bit_view::bit_view(stream &s, uint64_t offset, uint64_t nbits) {
+    _stream = &s;
+    _begin = offset;
+    _size = nbits;
+}
+
+bitio::bit_view bitio::bit_view::view(uint64_t offset, uint64_t nbits) const {
+    if (offset > _size || nbits > _size - offset) {
+        throw bitio_exception("bit_view: window out of range");
+    }
+
+    return {*_stream, _begin + offset, nbits};
+}
+
+void bitio::bit_view::check(uint64_t n) const {
+    if (n > _size - _position) {
+        throw bitio_exception("EOF encountered");
+    }
+}
+
+uint64_t bitio::bit_view::read(uint8_t n) {
+    check(n);
+    _stream->seek_to(_begin + _position);
+    uint64_t value = _stream->read(n);
+    _position += n;
+    return value;
+}
+
+void bitio::bit_view::write(uint64_t obj, uint8_t n) {
+    check(n);
+    _stream->seek_to(_begin + _position);
+    _stream->write(obj, n);
+    _position += n;
+}
+
+void bitio::bit_view::seek(int64_t n) {
+    if (n < 0 && uint64_t(-n) > _position) {
+        throw bitio_exception("SOF reached");
+    }
+
+    seek_to(_position + n);
+}
+
+void bitio::bit_view::seek_to(uint64_t n) {
+    if (n > _size) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    _position = n;
+}
+
+uint64_t bitio::bit_view::position() const {
+    return _position;
+}
+
+uint64_t bitio::bit_view::size() const {
+    return _size;
+}
+
+uint64_t bitio::bit_view::remaining() const {
+    return _size - _position;
+}
+
+bool bitio::bit_view::eof() const {
+    return _position == _size;
+}
+
+uint64_t bitio::bit_view::offset() const {
+    return _begin;
+}
+
+bitio::stream &bitio::bit_view::parent() const {
+    return *_stream;
+}
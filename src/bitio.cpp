@@ -1,5 +1,14 @@
 #include <bitio/bitio.h>
+#include <bitio/bits.h>
+#include <bitio/io_engine.h>
+#include <bitio/trace.h>
 #include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 bitio::bitio_exception::bitio_exception(std::string msg) {
     this->msg = "bitio: " + std::move(msg);
@@ -14,28 +23,13 @@ uint8_t bitio::stream::read_byte(uint64_t global_offset, bool capture_eof) {
     uint64_t index = global_offset % _buffer_size;
 
     if (offset != _buffer_offset) {
-        if (_file) {
-            // Commit changes to disk if necessary.
-            commit();
-
-            // Read from disk.
-            std::fseek(_file, global_offset - index, SEEK_SET);
-            _current_buffer_size = std::fread(_buffer, 1, _buffer_size, _file);
-            _buffer_offset = offset;
+        if (backed()) {
+            load_page(offset);
+        } else if (capture_eof) {
+            throw bitio_exception("EOF encountered");
         } else {
-            if (_reached_eof) {
-                throw bitio_exception("EOF encountered");
-            }
-
-            if (global_offset == _buffer_size) {
-                _reached_eof = true;
-            } else {
-                throw bitio_exception("EOF encountered");
-            }
-        }
-    } else {
-        if (!_file) {
-            _reached_eof = false;
+            _byte_head = global_offset;
+            return 0;
         }
     }
 
@@ -52,46 +46,416 @@ uint8_t bitio::stream::read_byte(uint64_t global_offset, bool capture_eof) {
     return _buffer[index];
 }
 
+bool bitio::stream::backed() const {
+    return _file || _fd >= 0 || _streambuf;
+}
+
+uint64_t bitio::stream::resident_bits() const {
+    if (!backed()) {
+        return UINT64_MAX;
+    }
+
+    uint64_t first = _bit_head == 8 ? _byte_head + 1 : _byte_head;
+    if (first / _buffer_size != _buffer_offset) {
+        return 0;
+    }
+
+    return ((_buffer_offset + 1) * _buffer_size - first) * 8 - (_bit_head & 0x7);
+}
+
+uint64_t bitio::stream::cursor_page() const {
+    return (_bit_head == 8 ? _byte_head + 1 : _byte_head) / _buffer_size;
+}
+
+void bitio::stream::touch() {
+    if (backed() && cursor_page() != _buffer_offset) {
+        load_page(cursor_page());
+    }
+}
+
+void bitio::stream::load_page(uint64_t offset) {
+    if (_streaming) {
+        load_ring_page(offset);
+        return;
+    }
+
+    // Commit changes to disk if necessary.
+    commit();
+
+    // Read from disk.
+    if (_codec) {
+        load_compressed_page(offset);
+    } else if (_fd >= 0 || _engine) {
+        ssize_t n = ::pread(io_fd(), _buffer, _buffer_size, offset * _buffer_size);
+        _current_buffer_size = n > 0 ? n : 0;
+    } else if (_streambuf) {
+        // Pages past the end of the buffer cannot be seeked to and are empty.
+        std::streamsize n = 0;
+        if (_streambuf->pubseekpos(offset * _buffer_size) == std::streampos(offset * _buffer_size)) {
+            n = _streambuf->sgetn(reinterpret_cast<char *>(_buffer), _buffer_size);
+        }
+        _current_buffer_size = n > 0 ? n : 0;
+    } else {
+        std::fseek(_file, offset * _buffer_size, SEEK_SET);
+        _current_buffer_size = std::fread(_buffer, 1, _buffer_size, _file);
+    }
+    _buffer_offset = offset;
+
+    // Whatever lies past a pending truncate() is gone already.
+    if (_truncate != UINT64_MAX) {
+        _current_buffer_size = std::min(_current_buffer_size, _truncate - std::min(_truncate, offset * _buffer_size));
+    }
+
+    _stats.page_loads++;
+    _stats.bytes_loaded += _current_buffer_size;
+    pad_page();
+
+    if (_checksums) {
+        record_checksum(offset, _buffer, _current_buffer_size, true);
+    }
+}
+
+const uint8_t *bitio::stream::page_for_read(uint64_t global_offset, uint64_t n, uint64_t &span) {
+    if (!backed()) {
+        if (global_offset + n > _buffer_size) {
+            throw bitio_exception("EOF encountered");
+        }
+
+        span = n;
+        return _buffer + global_offset;
+    }
+
+    uint64_t offset = global_offset / _buffer_size;
+    uint64_t index = global_offset % _buffer_size;
+
+    if (offset != _buffer_offset) {
+        load_page(offset);
+    }
+
+    if (index >= _current_buffer_size) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    span = std::min(n, _current_buffer_size - index);
+    return _buffer + index;
+}
+
+void bitio::stream::read_bytes(uint64_t global_offset, uint8_t *out, uint64_t n) {
+    while (n) {
+        uint64_t span;
+        const uint8_t *page = page_for_read(global_offset, n, span);
+        std::memcpy(out, page, span);
+
+        out += span;
+        global_offset += span;
+        n -= span;
+    }
+}
+
+uint8_t *bitio::stream::page_for_write(uint64_t global_offset, uint64_t n, uint64_t &span) {
+    if (!backed()) {
+        if (global_offset >= _buffer_size) {
+            throw bitio_exception("EOF encountered");
+        }
+
+        span = std::min(n, _buffer_size - global_offset);
+        return _buffer + global_offset;
+    }
+
+    if (_streaming) {
+        check_writable(global_offset);
+    }
+
+    uint64_t offset = global_offset / _buffer_size;
+    uint64_t index = global_offset % _buffer_size;
+
+    if (offset != _buffer_offset) {
+        load_page(offset);
+    }
+
+    // Bytes between the old end of the page and the write position would otherwise be stale buffer contents.
+    if (index > _current_buffer_size) {
+        std::memset(_buffer + _current_buffer_size, 0, index - _current_buffer_size);
+    }
+
+    span = std::min(n, _buffer_size - index);
+    _current_buffer_size = std::max(_current_buffer_size, index + span);
+    _dirty_begin = _requires_commit ? std::min(_dirty_begin, index) : index;
+    _requires_commit = true;
+    return _buffer + index;
+}
+
+void bitio::stream::write_bytes(uint64_t global_offset, const uint8_t *in, uint64_t n) {
+    while (n) {
+        uint64_t span;
+        uint8_t *page = page_for_write(global_offset, n, span);
+        std::memcpy(page, in, span);
+
+        in += span;
+        global_offset += span;
+        n -= span;
+    }
+}
+
+void bitio::stream::load_ring_page(uint64_t offset) {
+    if (_buffer_offset == _ring_last) {
+        _ring_tail_size = _current_buffer_size;
+    }
+
+    if (offset < _ring_first) {
+        throw bitio_exception("seek outside of streaming window");
+    }
+
+    if (offset > _ring_last && (_streaming & BITIO_STREAMING_IN) && _source_end) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    while (_ring_last < offset) {
+        // A finished output page is emitted right away, it stays in the ring for reading only.
+        if (_streaming & BITIO_STREAMING_OUT) {
+            _ring_tail_size = _buffer_size;
+            if (_checksums) {
+                record_checksum(_ring_last, ring_page(_ring_last), _buffer_size, false);
+            }
+            emit((_ring_last + 1) * _buffer_size);
+            sync_sink();
+        }
+
+        _ring_last++;
+        if (_ring_last - _ring_first >= BITIO_STREAMING_PAGES) {
+            _ring_first++;
+        }
+
+        uint8_t *page = ring_page(_ring_last);
+        if (_streaming & BITIO_STREAMING_IN) {
+            _ring_tail_size = pull(page, _buffer_size);
+            if (_checksums) {
+                record_checksum(_ring_last, page, _ring_tail_size, true);
+            }
+        } else {
+            std::memset(page, 0, _buffer_size);
+            _ring_tail_size = 0;
+        }
+    }
+
+    _buffer = ring_page(offset);
+    _buffer_offset = offset;
+    _current_buffer_size = offset == _ring_last ? _ring_tail_size : _buffer_size;
+}
+
+uint8_t *bitio::stream::ring_page(uint64_t offset) const {
+    return _allocation + (offset % BITIO_STREAMING_PAGES) * _buffer_size;
+}
+
+uint64_t bitio::stream::ring_end() const {
+    return _ring_last * _buffer_size + (_buffer_offset == _ring_last ? _current_buffer_size : _ring_tail_size);
+}
+
+void bitio::stream::emit(uint64_t end) {
+    while (_emitted < end) {
+        uint64_t page = _emitted / _buffer_size;
+        uint64_t index = _emitted % _buffer_size;
+        uint64_t span = std::min(end - _emitted, _buffer_size - index);
+
+        push(ring_page(page) + index, span);
+        _emitted += span;
+    }
+}
+
+void bitio::stream::check_writable(uint64_t global_offset) const {
+    if (_streaming & BITIO_STREAMING_IN) {
+        throw bitio_exception("streaming input is read-only");
+    }
+
+    if (global_offset < _emitted) {
+        throw bitio_exception("cannot write to emitted data");
+    }
+}
+
 void bitio::stream::commit() {
-    if (_requires_commit && _file) {
-        std::fseek(_file, _buffer_offset * _buffer_size, SEEK_SET);
-        std::fwrite(_buffer, 1, _current_buffer_size, _file);
+    if (_streaming) {
+        if (_streaming & BITIO_STREAMING_OUT) {
+            if (_checksums) {
+                record_checksum(_ring_last, ring_page(_ring_last), ring_end() - _ring_last * _buffer_size, false);
+            }
+            emit(ring_end());
+            sync_sink();
+        }
+        return;
+    }
+
+    if (_requires_commit && _checksums) {
+        record_checksum(_buffer_offset, _buffer, _current_buffer_size, false);
+    }
+
+    if (_requires_commit && backed()) {
+        _stats.page_commits++;
+
+        if (_truncate != UINT64_MAX) {
+            _truncate = std::max(_truncate, _buffer_offset * _buffer_size + _current_buffer_size);
+        }
+    }
+
+    if (_requires_commit && _codec) {
+        commit_compressed();
+        _requires_commit = false;
+    } else if (_requires_commit && _engine) {
+        commit_direct();
+    } else if (_requires_commit && _file) {
+        // Only the page from its first dirty byte on is written, so a gap skipped past the end of the file by a
+        // seek stays a hole.
+        if (_dirty_begin < _current_buffer_size) {
+            std::fseek(_file, _buffer_offset * _buffer_size + _dirty_begin, SEEK_SET);
+            std::fwrite(_buffer + _dirty_begin, 1, _current_buffer_size - _dirty_begin, _file);
+            _stats.bytes_committed += _current_buffer_size - _dirty_begin;
+        }
         _requires_commit = false;
+    } else if (_requires_commit && _streambuf) {
+        if (_dirty_begin < _current_buffer_size) {
+            seek_sink(_buffer_offset * _buffer_size + _dirty_begin);
+            push(_buffer + _dirty_begin, _current_buffer_size - _dirty_begin);
+            _stats.bytes_committed += _current_buffer_size - _dirty_begin;
+        }
+        _requires_commit = false;
+    } else if (_requires_commit && _fd >= 0) {
+        commit_direct();
+    }
+}
+
+void bitio::stream::commit_direct() {
+    uint64_t length = writeback_length();
+    if (::pwrite(io_fd(), _buffer, length, _buffer_offset * _buffer_size) != ssize_t(length)) {
+        throw bitio_exception("page write-back failed");
     }
+    _stats.bytes_committed += length;
+    finish_writeback(length);
+}
+
+uint64_t bitio::stream::writeback_length() {
+    if (_fd < 0) {
+        return _current_buffer_size;
+    }
+
+    // O_DIRECT only transfers whole blocks, so a partial tail page is zero padded and the file is truncated
+    // back to its logical size afterwards.
+    uint64_t length = (_current_buffer_size + BITIO_DIRECT_ALIGNMENT - 1) & ~uint64_t(BITIO_DIRECT_ALIGNMENT - 1);
+    std::memset(_buffer + _current_buffer_size, 0, length - _current_buffer_size);
+    return length;
+}
+
+void bitio::stream::finish_writeback(uint64_t length) {
+    _requires_commit = false;
+    if (_fd < 0) {
+        return;
+    }
+
+    uint64_t position = _buffer_offset * _buffer_size;
+    _direct_size = std::max(_direct_size, position + _current_buffer_size);
+    if (length != _current_buffer_size) {
+        (void) ::ftruncate(_fd, _direct_size);
+    }
+}
+
+bool bitio::stream::open_direct(const std::string &filename) {
+#ifdef O_DIRECT
+    int fd = ::open(filename.c_str(), O_RDWR | O_DIRECT);
+    if (fd < 0) {
+        return false;
+    }
+
+    uint64_t buffer_size = _buffer_size;
+    _buffer_size = (_buffer_size + BITIO_DIRECT_ALIGNMENT - 1) & ~uint64_t(BITIO_DIRECT_ALIGNMENT - 1);
+    allocate_buffer(_buffer_size, BITIO_DIRECT_ALIGNMENT);
+
+    // Some filesystems accept O_DIRECT on open() but reject the transfer itself.
+    ssize_t n = ::pread(fd, _buffer, _buffer_size, 0);
+    struct stat st{};
+    if (n < 0 || ::fstat(fd, &st) != 0) {
+        deallocate_buffer();
+        _buffer_size = buffer_size;
+        ::close(fd);
+        return false;
+    }
+
+    _fd = fd;
+    _current_buffer_size = n;
+    _direct_size = st.st_size;
+    pad_page();
+
+    if (_checksums) {
+        record_checksum(0, _buffer, _current_buffer_size, true);
+    }
+    return true;
+#else
+    return false;
+#endif
 }
 
 void bitio::stream::write_byte(uint64_t global_offset, uint8_t byte) {
+    if (_streaming) {
+        check_writable(global_offset);
+    }
+
     uint64_t offset = global_offset / _buffer_size;
     uint64_t index = global_offset % _buffer_size;
 
     if (offset != _buffer_offset) {
-        if (_file) {
-            // Commit changes to disk if necessary.
-            commit();
-
-            // Read from disk.
-            std::fseek(_file, global_offset - index, SEEK_SET);
-            _current_buffer_size = std::fread(_buffer, 1, _buffer_size, _file);
-            _buffer_offset = offset;
+        if (backed()) {
+            load_page(offset);
         } else {
             throw bitio_exception("EOF encountered");
         }
     }
 
     if (index >= _current_buffer_size) {
+        std::memset(_buffer + _current_buffer_size, 0, index - _current_buffer_size);
         _current_buffer_size = index + 1;
     }
     _byte_head = global_offset;
     _buffer[index] = byte;
+    _dirty_begin = _requires_commit ? std::min(_dirty_begin, index) : index;
     _requires_commit = true;
 }
 
-bitio::stream::stream(FILE *file, uint64_t buffer_size) {
+bitio::stream::stream(FILE *file, uint64_t buffer_size, uint32_t flags, allocator *alloc) {
     this->_file = file;
+    open_pages(buffer_size, flags, alloc);
+}
+
+bitio::stream::stream(std::streambuf *buffer, uint64_t buffer_size, uint32_t flags, allocator *alloc) {
+    this->_streambuf = buffer;
+    open_pages(buffer_size, flags, alloc);
+}
+
+void bitio::stream::open_pages(uint64_t buffer_size, uint32_t flags, allocator *alloc) {
     this->_buffer_size = buffer_size;
-    this->_buffer = new uint8_t [buffer_size];
+    this->_allocator = alloc ? alloc : heap_allocator();
+    this->_checksums = flags & BITIO_CHECKSUM;
+
+    // Pipes and sockets cannot seek, so the last few pages are kept in a ring and never re-read.
+    if (flags & (BITIO_STREAMING_IN | BITIO_STREAMING_OUT)) {
+        _streaming = flags & (BITIO_STREAMING_IN | BITIO_STREAMING_OUT);
+        allocate_buffer(buffer_size * BITIO_STREAMING_PAGES, BITIO_DEFAULT_ALIGNMENT);
+
+        if (_streaming & BITIO_STREAMING_IN) {
+            _current_buffer_size = pull(_buffer, buffer_size);
+            if (_checksums) {
+                record_checksum(0, _buffer, _current_buffer_size, true);
+            }
+        } else {
+            std::memset(_buffer, 0, buffer_size);
+        }
+        return;
+    }
 
-    _current_buffer_size = std::fread(_buffer, 1, buffer_size, file);
+    _padded = flags & BITIO_PADDED;
+    allocate_buffer(buffer_size, BITIO_DEFAULT_ALIGNMENT);
+
+    _current_buffer_size = pull(_buffer, buffer_size);
+    pad_page();
+    if (_checksums) {
+        record_checksum(0, _buffer, _current_buffer_size, true);
+    }
 }
 
 bitio::stream::stream(uint8_t *raw, uint64_t buffer_size) {
@@ -101,17 +465,53 @@ bitio::stream::stream(uint8_t *raw, uint64_t buffer_size) {
 }
 
 void bitio::stream::flush() {
+    if (_trace) {
+        _trace->record(trace_op::flush, 0);
+    }
+
     commit();
+
+    if (_codec && _table_dirty) {
+        write_page_table();
+    }
+
+    // Committed pages may still sit in the stdio buffer.
+    if (_file || _streambuf) {
+        sync_sink();
+    }
+
+    if (_truncate != UINT64_MAX) {
+        (void) ::ftruncate(io_fd(), _truncate);
+        _direct_size = _truncate;
+        _truncate = UINT64_MAX;
+    }
 }
 
 uint64_t bitio::stream::size() {
+    if (_streaming) {
+        return ring_end();
+    }
+
+    if (_fd >= 0) {
+        return std::min(_direct_size, _truncate);
+    }
+
+    if (_codec) {
+        return _page_table.empty() ? 0 : (_page_table.size() - 1) * _buffer_size + _page_table.back().raw;
+    }
+
+    if (_streambuf) {
+        auto end = _streambuf->pubseekoff(0, std::ios_base::end);
+        return end < 0 ? 0 : uint64_t(end);
+    }
+
     if (!_file) {
         return _buffer_size;
     }
 
     std::fseek(_file, 0, SEEK_END);
     uint64_t fsize = std::ftell(_file);
-    return fsize;
+    return std::min(fsize, _truncate);
 }
 
 uint64_t bitio::stream::read(uint8_t n) {
@@ -119,6 +519,30 @@ uint64_t bitio::stream::read(uint8_t n) {
         return 0;
     }
 
+    if (_trace) {
+        _trace->record(trace_op::read, n);
+    }
+
+    // Fast path: when the 9 bytes holding the value are in the page, it is a single load. The data ends in a
+    // short page, so with padding its whole tail qualifies. A cursor outside of the page wraps the index around
+    // and fails the same check.
+    uint64_t first = _byte_head + (_bit_head >> 3);
+    uint8_t shift = _bit_head & 0x7;
+    uint64_t index = first - _buffer_offset * _buffer_size;
+    uint64_t limit = _padded && _current_buffer_size < _buffer_size ? _buffer_size + BITIO_READ_PADDING
+                                                                   : _current_buffer_size;
+
+    if (limit >= 9 && index <= limit - 9) {
+        const uint8_t *p = _buffer + index;
+        uint64_t value = (load_be64(p) << shift) | (uint64_t(p[8]) >> (8 - shift));
+        uint64_t end = (index << 3) + shift + n;
+
+        _overrun |= end > _current_buffer_size << 3;
+        _byte_head = first + ((shift + n) >> 3);
+        _bit_head = (shift + n) & 0x7;
+        return value >> (0x40 - n);
+    }
+
     uint64_t value = 0;
     uint8_t nbytes = n >> 3;
     uint8_t nbits = n & 0x7;
@@ -174,24 +598,86 @@ uint64_t bitio::stream::read(uint8_t n) {
 uint8_t bitio::stream::read_next_byte() {
     if (_bit_head == 8) {
         _bit_head = 0;
-        return read_byte(_byte_head + 1);
-    } else {
+        _byte_head++;
+    }
+
+    if (!_padded) {
         return read_byte(_byte_head);
     }
+
+    uint8_t byte = read_byte(_byte_head, false);
+    if (_byte_head - _buffer_offset * _buffer_size >= _current_buffer_size) {
+        _overrun = true;
+    }
+    return byte;
+}
+
+std::optional<uint64_t> bitio::stream::try_read(uint8_t n) {
+    uint64_t position = this->position();
+    uint64_t page_begin = _buffer_offset * _buffer_size * 8;
+
+    // Reads within the current page cannot fail.
+    if (position >= page_begin && position + n <= page_begin + _current_buffer_size * 8) {
+        return read(n);
+    }
+
+    if (_streaming & BITIO_STREAMING_IN) {
+        try {
+            return read(n);
+        } catch (bitio_exception &) {
+            return std::nullopt;
+        }
+    }
+
+    if (position + n > data_end()) {
+        return std::nullopt;
+    }
+
+    return read(n);
+}
+
+bool bitio::stream::overrun() const {
+    return _overrun;
+}
+
+uint64_t bitio::stream::data_end() {
+    if (!backed()) {
+        return _buffer_size * 8;
+    }
+
+    // The cached page may be dirty and longer than what is on disk.
+    uint64_t cached = _buffer_offset * _buffer_size + _current_buffer_size;
+    if (_streaming) {
+        return std::max(cached, ring_end()) * 8;
+    }
+
+    return std::max(cached, size()) * 8;
 }
 
 void bitio::stream::seek_to(uint64_t n) {
+    if (_trace) {
+        _trace->record(trace_op::seek_to, n);
+    }
+
     uint64_t nbytes = n >> 3;
     uint64_t nbits = n & 0x7;
     _byte_head = nbytes;
     _bit_head = nbits;
 }
 
+uint64_t bitio::stream::position() const {
+    return _bit_head == 8 ? (_byte_head + 1) << 3 : (_byte_head << 3) + _bit_head;
+}
+
 void bitio::stream::seek(int64_t n) {
     if (n == 0) {
         return;
     }
 
+    if (_trace) {
+        _trace->record(trace_op::seek, n);
+    }
+
     if (_bit_head == 8) {
         _byte_head++;
         _bit_head = 0;
@@ -237,6 +723,10 @@ void bitio::stream::write(uint64_t obj, uint8_t n) {
         throw bitio_exception("write() supports upto 64-bits only");
     }
 
+    if (_trace) {
+        _trace->record(trace_op::write, n);
+    }
+
     obj <<= (0x40 - n);
     uint8_t patch_byte = fetch_next_byte();
     bool residual = false;
@@ -251,8 +741,13 @@ void bitio::stream::write(uint64_t obj, uint8_t n) {
 
         if (_bit_head == 8) {
             write_byte(_byte_head, patch_byte);
-            patch_byte = fetch_next_byte();
             residual = false;
+
+            // File-backed streams only fetch the next byte once it is written to, so filling up a page does not
+            // fault in the next one.
+            if (i + 1 < n || !backed()) {
+                patch_byte = fetch_next_byte();
+            }
         }
     }
 
@@ -271,21 +766,266 @@ uint8_t bitio::stream::fetch_next_byte() {
 }
 
 bitio::stream::~stream() {
-    commit();
+    release();
+}
+
+void bitio::stream::release() {
+    if (_prefetch.valid()) {
+        _prefetch.wait();
+    }
+
+    // As with fclose(), a failed write-back while closing cannot be reported.
+    if (_engine) {
+        _engine->drop(*this);
+    }
+
+    try {
+        flush();
+    } catch (bitio_exception &) {}
+
+    // Truncating to the current size frees the blocks reserved past it.
+    if (_reserved && backed()) {
+        if (_reserved > size()) {
+            (void) ::ftruncate(io_fd(), size());
+        }
+        _reserved = 0;
+    }
+
     if (_file) {
-        delete[] _buffer;
         std::fclose(_file);
+    } else if (_fd >= 0) {
+        ::close(_fd);
+    }
+
+    deallocate_buffer();
+
+    if (_prefetch_buffer) {
+        _allocator->deallocate(_prefetch_buffer, _allocation_size, _allocation_alignment);
+        _prefetch_buffer = nullptr;
+    }
+}
+
+void bitio::stream::allocate_buffer(uint64_t size, uint64_t alignment) {
+    if (_padded) {
+        size += BITIO_READ_PADDING;
+    }
+
+    _allocation_size = size;
+    _allocation_alignment = alignment;
+    _allocation = _allocator->allocate(size, alignment);
+    _buffer = _allocation;
+}
+
+void bitio::stream::pad_page() {
+    if (_padded) {
+        std::memset(_buffer + _current_buffer_size, 0, _buffer_size + BITIO_READ_PADDING - _current_buffer_size);
+    }
+}
+
+void bitio::stream::deallocate_buffer() {
+    if (_allocator && _allocation) {
+        _allocator->deallocate(_allocation, _allocation_size, _allocation_alignment);
+    }
+    _allocation = nullptr;
+    _buffer = nullptr;
+}
+
+void bitio::stream::take(stream &other) {
+    io_engine *engine = other._engine;
+    if (engine) {
+        engine->drop(other);
+    }
+
+    _buffer = std::exchange(other._buffer, nullptr);
+    _allocator = std::exchange(other._allocator, nullptr);
+    _allocation = std::exchange(other._allocation, nullptr);
+    _allocation_size = other._allocation_size;
+    _allocation_alignment = other._allocation_alignment;
+    _buffer_offset = other._buffer_offset;
+    _buffer_size = other._buffer_size;
+    _current_buffer_size = other._current_buffer_size;
+    _byte_head = other._byte_head;
+    _bit_head = other._bit_head;
+    _file = std::exchange(other._file, nullptr);
+    _streambuf = std::exchange(other._streambuf, nullptr);
+    _source_end = other._source_end;
+    _fd = std::exchange(other._fd, -1);
+    _direct_size = other._direct_size;
+    _streaming = std::exchange(other._streaming, 0);
+    _ring_first = other._ring_first;
+    _ring_last = other._ring_last;
+    _ring_tail_size = other._ring_tail_size;
+    _emitted = other._emitted;
+    _checksums = other._checksums;
+    _page_checksums = std::move(other._page_checksums);
+    _expected_checksums = std::move(other._expected_checksums);
+    _codec = std::exchange(other._codec, nullptr);
+    _page_table = std::move(other._page_table);
+    _scratch = std::move(other._scratch);
+    _data_end = other._data_end;
+    _table_dirty = std::exchange(other._table_dirty, false);
+    _last_loaded = other._last_loaded;
+    _prefetch_buffer = std::exchange(other._prefetch_buffer, nullptr);
+    _prefetch_page = other._prefetch_page;
+    _prefetch = std::move(other._prefetch);
+    _requires_commit = std::exchange(other._requires_commit, false);
+    _dirty_begin = other._dirty_begin;
+    _reserved = std::exchange(other._reserved, 0);
+    _truncate = std::exchange(other._truncate, UINT64_MAX);
+    _padded = other._padded;
+    _overrun = other._overrun;
+    _stats = other._stats;
+    _trace = std::exchange(other._trace, nullptr);
+
+    if (engine) {
+        engine->attach(*this);
+    }
+}
+
+bitio::stream::stream(stream &&other) noexcept {
+    take(other);
+}
+
+bitio::stream &bitio::stream::operator=(stream &&other) noexcept {
+    if (this != &other) {
+        release();
+        take(other);
     }
+    return *this;
 }
 
-bitio::stream::stream(const std::string &filename, uint64_t buffer_size) {
+bitio::stream::stream(const std::string &filename, uint64_t buffer_size, uint32_t flags, allocator *alloc,
+                      page_codec *codec) {
     if (!std::filesystem::exists(filename)) {
         auto tmp = std::fopen(filename.c_str(), "a");
         std::fclose(tmp);
     }
 
-    _file = std::fopen(filename.c_str(), "rb+");
     _buffer_size = buffer_size;
-    _buffer = new uint8_t [buffer_size];
+    _allocator = alloc ? alloc : heap_allocator();
+    _checksums = flags & BITIO_CHECKSUM;
+
+    if (codec) {
+        _file = std::fopen(filename.c_str(), "rb+");
+        _codec = codec;
+        open_compressed();
+
+        allocate_buffer(_buffer_size, BITIO_DEFAULT_ALIGNMENT);
+        _prefetch_buffer = _allocator->allocate(_allocation_size, _allocation_alignment);
+        load_page(0);
+        return;
+    }
+
+    _padded = flags & BITIO_PADDED;
+
+    // Fall back to buffered I/O when the filesystem does not support O_DIRECT.
+    if ((flags & BITIO_DIRECT_IO) && open_direct(filename)) {
+        return;
+    }
+
+    _file = std::fopen(filename.c_str(), "rb+");
+    allocate_buffer(buffer_size, BITIO_DEFAULT_ALIGNMENT);
     _current_buffer_size = std::fread(_buffer, 1, buffer_size, _file);
+    pad_page();
+    if (_checksums) {
+        record_checksum(0, _buffer, _current_buffer_size, true);
+    }
+}
+
+const bitio::stream_stats &bitio::stream::stats() const {
+    return _stats;
+}
+
+void bitio::stream::trace(trace_recorder *recorder) {
+    _trace = recorder;
+    if (_trace) {
+        _trace->record(trace_op::begin, size());
+        _trace->record(trace_op::seek_to, position());
+    }
+}
+
+bool bitio::stream::direct() const {
+    return _fd >= 0;
+}
+
+bool bitio::stream::preallocate(uint64_t nbytes) {
+    if (!backed() || _streambuf || _streaming || _codec) {
+        return false;
+    }
+
+#if defined(__linux__)
+    if (::fallocate(io_fd(), FALLOC_FL_KEEP_SIZE, 0, nbytes) != 0) {
+        return false;
+    }
+
+    _reserved = std::max(_reserved, nbytes);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void bitio::stream::truncate(uint64_t nbits) {
+    if (!backed() || _streambuf || _streaming || _codec) {
+        throw bitio_exception("truncate() needs a plain file stream");
+    }
+
+    uint64_t nbytes = (nbits + 7) >> 3;
+    uint8_t tail = nbits & 0x7;
+    if (tail && nbytes <= data_end() >> 3) {
+        uint8_t last;
+        read_bytes(nbytes - 1, &last, 1);
+        last &= u8_lmasks[tail];
+        write_bytes(nbytes - 1, &last, 1);
+    }
+
+    // The cached page drops its bytes past the end, pages loaded later are clamped by load_page().
+    uint64_t page_begin = _buffer_offset * _buffer_size;
+    if (page_begin + _current_buffer_size > nbytes) {
+        _current_buffer_size = nbytes - std::min(nbytes, page_begin);
+        pad_page();
+    }
+
+    _truncate = nbytes;
+}
+
+uint64_t bitio::stream::pull(uint8_t *out, uint64_t n) {
+    uint64_t count = _streambuf ? std::max<std::streamsize>(_streambuf->sgetn(reinterpret_cast<char *>(out), n), 0)
+                                : std::fread(out, 1, n, _file);
+    _source_end = count < n;
+    return count;
+}
+
+void bitio::stream::push(const uint8_t *in, uint64_t n) {
+    auto data = reinterpret_cast<const char *>(in);
+    uint64_t count = _streambuf ? std::max<std::streamsize>(_streambuf->sputn(data, n), 0)
+                                : std::fwrite(data, 1, n, _file);
+    if (count != n) {
+        throw bitio_exception("short write");
+    }
+}
+
+void bitio::stream::seek_sink(uint64_t position) {
+    auto end = _streambuf->pubseekoff(0, std::ios_base::end);
+    if (end < 0) {
+        throw bitio_exception("streambuf: seek failed");
+    }
+
+    // A streambuf cannot seek past its end, so a gap up to the position is written as zeros.
+    if (position > uint64_t(end)) {
+        static const uint8_t zeros[0x1000]{};
+        for (uint64_t gap = position - end; gap;) {
+            uint64_t n = std::min<uint64_t>(gap, sizeof(zeros));
+            push(zeros, n);
+            gap -= n;
+        }
+    } else if (_streambuf->pubseekpos(position) != std::streampos(position)) {
+        throw bitio_exception("streambuf: seek failed");
+    }
+}
+
+void bitio::stream::sync_sink() {
+    if (_streambuf ? _streambuf->pubsync() == -1 : std::fflush(_file) != 0) {
+        throw bitio_exception("flush failed");
+    }
 }
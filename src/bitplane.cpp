@@ -0,0 +1,234 @@
+#include <bitio/bitplane.h>
+#include <bitio/bits.h>
+#include <bitio/cpu.h>
+#include <algorithm>
+#include <vector>
+#include "kernels.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#define BITIO_BITPLANE_BATCH_SIZE 0x1000
+
+namespace {
+    // Transposes an 8x8 bit matrix held MSB-first, row 0 in the top byte.
+    inline uint64_t transpose8(uint64_t x) {
+        uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+        x ^= t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+        x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+        x ^= t ^ (t << 28);
+        return x;
+    }
+
+    // One swap stage of the 64x64 transpose: rows k and k + j exchange the blocks selected by mask.
+    inline void transpose_stage(uint64_t *rows, uint8_t j, uint64_t mask) {
+        for (uint8_t k = 0; k < 0x40; k = (k + j + 1) & ~j) {
+            uint64_t t = (rows[k] ^ (rows[k + j] >> j)) & mask;
+            rows[k] ^= t;
+            rows[k + j] ^= t << j;
+        }
+    }
+
+    // Planes of up to 64 values, plane k in planes[63 - k] with value 0 in the top bit.
+    void to_planes(const uint64_t *values, uint64_t n, uint8_t width, uint64_t *planes,
+                   void (*transpose64)(uint64_t *)) {
+        if (width <= 8) {
+            std::fill(planes + 0x40 - width, planes + 0x40, 0);
+            for (uint64_t g = 0; g < 8; g++) {
+                uint64_t x = 0;
+                for (uint64_t i = 0; i < 8; i++) {
+                    uint64_t index = g * 8 + i;
+                    x |= (index < n ? values[index] & 0xff : 0) << (56 - 8 * i);
+                }
+
+                x = transpose8(x);
+                for (uint8_t k = 0; k < width; k++) {
+                    planes[0x3f - k] |= ((x >> (8 * k)) & 0xff) << (56 - 8 * g);
+                }
+            }
+            return;
+        }
+
+        std::copy(values, values + n, planes);
+        std::fill(planes + n, planes + 0x40, 0);
+        transpose64(planes);
+    }
+
+    void from_planes(uint64_t *planes, uint64_t n, uint8_t width, uint64_t *values,
+                     void (*transpose64)(uint64_t *)) {
+        if (width <= 8) {
+            for (uint64_t g = 0; g < 8 && g * 8 < n; g++) {
+                uint64_t x = 0;
+                for (uint8_t k = 0; k < width; k++) {
+                    x |= ((planes[0x3f - k] >> (56 - 8 * g)) & 0xff) << (8 * k);
+                }
+
+                x = transpose8(x);
+                for (uint64_t i = 0; i < 8 && g * 8 + i < n; i++) {
+                    values[g * 8 + i] = (x >> (56 - 8 * i)) & 0xff;
+                }
+            }
+            return;
+        }
+
+        std::fill(planes, planes + 0x40 - width, 0);
+        transpose64(planes);
+        std::copy(planes, planes + n, values);
+    }
+
+    void check(uint8_t width, uint16_t block) {
+        if (width == 0 || width > 0x40) {
+            throw bitio::bitio_exception("bitplanes: width must be between 1 and 64 bits");
+        }
+
+        if (block != 0x40 && block != 0x80 && block != 0x100) {
+            throw bitio::bitio_exception("bitplanes: block size must be 64, 128 or 256");
+        }
+    }
+}
+
+void bitio::impl::transpose64_scalar(uint64_t *rows) {
+    uint64_t mask = 0x00000000ffffffffull;
+    for (uint8_t j = 0x20; j; j >>= 1, mask ^= mask << j) {
+        transpose_stage(rows, j, mask);
+    }
+}
+
+#if defined(__x86_64__)
+// The stages with j >= 4 pair up runs of four rows and vectorize directly, the last two stay scalar.
+__attribute__((target("avx2")))
+void bitio::impl::transpose64_avx2(uint64_t *rows) {
+    uint64_t mask = 0x00000000ffffffffull;
+    uint8_t j = 0x20;
+    for (; j >= 4; j >>= 1, mask ^= mask << j) {
+        __m256i m = _mm256_set1_epi64x(int64_t(mask));
+        for (uint8_t k = 0; k < 0x40; k = (k + j + 4) & ~j) {
+            __m256i a = _mm256_loadu_si256((const __m256i *) (rows + k));
+            __m256i b = _mm256_loadu_si256((const __m256i *) (rows + k + j));
+            __m256i t = _mm256_and_si256(_mm256_xor_si256(a, _mm256_srli_epi64(b, j)), m);
+            _mm256_storeu_si256((__m256i *) (rows + k), _mm256_xor_si256(a, t));
+            _mm256_storeu_si256((__m256i *) (rows + k + j), _mm256_xor_si256(b, _mm256_slli_epi64(t, j)));
+        }
+    }
+
+    for (; j; j >>= 1, mask ^= mask << j) {
+        transpose_stage(rows, j, mask);
+    }
+}
+
+__attribute__((target("avx2,avx512f")))
+void bitio::impl::transpose64_avx512(uint64_t *rows) {
+    uint64_t mask = 0x00000000ffffffffull;
+    uint8_t j = 0x20;
+    for (; j >= 8; j >>= 1, mask ^= mask << j) {
+        __m512i m = _mm512_set1_epi64(int64_t(mask));
+        for (uint8_t k = 0; k < 0x40; k = (k + j + 8) & ~j) {
+            __m512i a = _mm512_loadu_si512(rows + k);
+            __m512i b = _mm512_loadu_si512(rows + k + j);
+            // Zero-masked shifts, GCC warns about the undefined passthrough of the plain ones.
+            __m512i t = _mm512_and_si512(_mm512_xor_si512(a, _mm512_maskz_srli_epi64(0xff, b, j)), m);
+            _mm512_storeu_si512(rows + k, _mm512_xor_si512(a, t));
+            _mm512_storeu_si512(rows + k + j, _mm512_xor_si512(b, _mm512_maskz_slli_epi64(0xff, t, j)));
+        }
+    }
+
+    __m256i m = _mm256_set1_epi64x(int64_t(mask));
+    for (uint8_t k = 0; k < 0x40; k = (k + j + 4) & ~j) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (rows + k));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (rows + k + j));
+        __m256i t = _mm256_and_si256(_mm256_xor_si256(a, _mm256_srli_epi64(b, j)), m);
+        _mm256_storeu_si256((__m256i *) (rows + k), _mm256_xor_si256(a, t));
+        _mm256_storeu_si256((__m256i *) (rows + k + j), _mm256_xor_si256(b, _mm256_slli_epi64(t, j)));
+    }
+    j >>= 1;
+    mask ^= mask << j;
+
+    for (; j; j >>= 1, mask ^= mask << j) {
+        transpose_stage(rows, j, mask);
+    }
+}
+#endif
+
+void bitio::write_bitplanes(stream &s, const uint64_t *values, uint64_t count, uint8_t width, uint16_t block) {
+    check(width, block);
+
+    auto transpose64 = kernels().transpose64;
+    std::vector<uint8_t> buffer(BITIO_BITPLANE_BATCH_SIZE * 8 + 8);
+    uint64_t planes[4][0x40];
+    uint64_t position = s.position();
+
+    while (count) {
+        uint64_t m = std::min<uint64_t>(count, BITIO_BITPLANE_BATCH_SIZE);
+        bit_packer packer(buffer.data());
+
+        for (uint64_t b = 0; b < m; b += block) {
+            uint64_t n = std::min<uint64_t>(block, m - b);
+            uint64_t chunks = (n + 0x3f) >> 6;
+            for (uint64_t c = 0; c < chunks; c++) {
+                to_planes(values + b + c * 0x40, std::min<uint64_t>(0x40, n - c * 0x40), width, planes[c], transpose64);
+            }
+
+            for (uint8_t k = width; k-- > 0;) {
+                for (uint64_t c = 0; c < chunks; c++) {
+                    uint8_t bits = std::min<uint64_t>(0x40, n - c * 0x40);
+                    packer.put(planes[c][0x3f - k] >> (0x40 - bits), bits);
+                }
+            }
+        }
+        packer.finish();
+
+        stream batch(buffer.data(), buffer.size());
+        copy_bits(batch, 0, s, position, packer.size());
+
+        position += packer.size();
+        values += m;
+        count -= m;
+    }
+
+    s.seek_to(position);
+}
+
+void bitio::read_bitplanes(stream &s, uint64_t *values, uint64_t count, uint8_t width, uint16_t block) {
+    check(width, block);
+
+    auto transpose64 = kernels().transpose64;
+    std::vector<uint8_t> buffer(BITIO_BITPLANE_BATCH_SIZE * 8 + 16);
+    uint64_t planes[4][0x40];
+    uint64_t position = s.position();
+
+    while (count) {
+        uint64_t m = std::min<uint64_t>(count, BITIO_BITPLANE_BATCH_SIZE);
+        uint64_t nbits = m * width;
+
+        stream batch(buffer.data(), buffer.size());
+        copy_bits(s, position, batch, 0, nbits);
+
+        uint64_t offset = 0;
+        for (uint64_t b = 0; b < m; b += block) {
+            uint64_t n = std::min<uint64_t>(block, m - b);
+            uint64_t chunks = (n + 0x3f) >> 6;
+
+            for (uint8_t k = width; k-- > 0;) {
+                for (uint64_t c = 0; c < chunks; c++) {
+                    uint8_t bits = std::min<uint64_t>(0x40, n - c * 0x40);
+                    planes[c][0x3f - k] = extract_bits(buffer.data(), offset, bits) << (0x40 - bits);
+                    offset += bits;
+                }
+            }
+
+            for (uint64_t c = 0; c < chunks; c++) {
+                from_planes(planes[c], std::min<uint64_t>(0x40, n - c * 0x40), width, values + b + c * 0x40,
+                            transpose64);
+            }
+        }
+
+        position += nbits;
+        values += m;
+        count -= m;
+    }
+
+    s.seek_to(position);
+}
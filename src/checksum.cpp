@@ -0,0 +1,265 @@
+#include <bitio/bitio.h>
+#include <bitio/checksum.h>
+#include <cstring>
+#include <bitio/bits.h>
+#include <bitio/cpu.h>
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#endif
+
+#define BITIO_CRC32C_POLY 0x82f63b78
+#define BITIO_CHECKSUM_CHUNK_SIZE 0x10000
+
+namespace {
+    struct crc32c_tables {
+        uint32_t t[8][256]{};
+
+        crc32c_tables() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for (int k = 0; k < 8; k++) {
+                    crc = (crc >> 1) ^ (BITIO_CRC32C_POLY & (0 - (crc & 1)));
+                }
+                t[0][i] = crc;
+            }
+
+            for (uint32_t i = 0; i < 256; i++) {
+                for (int k = 1; k < 8; k++) {
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+                }
+            }
+        }
+    };
+
+    const crc32c_tables tables;
+
+    uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec) {
+        uint32_t sum = 0;
+        while (vec) {
+            if (vec & 1) {
+                sum ^= *mat;
+            }
+            vec >>= 1;
+            mat++;
+        }
+        return sum;
+    }
+
+    void gf2_matrix_square(uint32_t *square, const uint32_t *mat) {
+        for (int n = 0; n < 32; n++) {
+            square[n] = gf2_matrix_times(mat, mat[n]);
+        }
+    }
+}
+
+// Slice-by-8 fallback.
+uint32_t bitio::impl::crc32c_scalar(uint32_t crc, const uint8_t *data, uint64_t n) {
+    while (n >= 8) {
+        uint64_t v;
+        std::memcpy(&v, data, 8);
+        v ^= crc;
+        crc = tables.t[7][v & 0xff] ^ tables.t[6][(v >> 8) & 0xff] ^ tables.t[5][(v >> 16) & 0xff] ^
+              tables.t[4][(v >> 24) & 0xff] ^ tables.t[3][(v >> 32) & 0xff] ^ tables.t[2][(v >> 40) & 0xff] ^
+              tables.t[1][(v >> 48) & 0xff] ^ tables.t[0][v >> 56];
+        data += 8;
+        n -= 8;
+    }
+
+    while (n--) {
+        crc = (crc >> 8) ^ tables.t[0][(crc ^ *data++) & 0xff];
+    }
+
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+uint32_t bitio::impl::crc32c_sse42(uint32_t crc, const uint8_t *data, uint64_t n) {
+    uint64_t c = crc;
+    while (n >= 8) {
+        uint64_t v;
+        std::memcpy(&v, data, 8);
+        c = _mm_crc32_u64(c, v);
+        data += 8;
+        n -= 8;
+    }
+
+    crc = c;
+    while (n--) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+
+    return crc;
+}
+#endif
+
+uint32_t bitio::crc32c(uint32_t crc, const uint8_t *data, uint64_t n) {
+    return ~kernels().crc32c(~crc, data, n);
+}
+
+uint32_t bitio::crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2) {
+    if (len2 == 0) {
+        return crc1;
+    }
+
+    // Apply len2 zero bytes to crc1 by repeated squaring of the one-zero-bit operator, as zlib does.
+    uint32_t even[32];
+    uint32_t odd[32];
+
+    odd[0] = BITIO_CRC32C_POLY;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+
+    do {
+        gf2_matrix_square(even, odd);
+        if (len2 & 1) {
+            crc1 = gf2_matrix_times(even, crc1);
+        }
+        len2 >>= 1;
+
+        if (len2 == 0) {
+            break;
+        }
+
+        gf2_matrix_square(odd, even);
+        if (len2 & 1) {
+            crc1 = gf2_matrix_times(odd, crc1);
+        }
+        len2 >>= 1;
+    } while (len2);
+
+    return crc1 ^ crc2;
+}
+
+void bitio::stream::record_checksum(uint64_t page, const uint8_t *data, uint64_t n, bool loaded) {
+    uint32_t crc = crc32c(0, data, n);
+
+    if (loaded && page < _expected_checksums.size() && _expected_checksums[page] &&
+        *_expected_checksums[page] != crc) {
+        throw bitio_exception("checksum mismatch");
+    }
+
+    if (page >= _page_checksums.size()) {
+        _page_checksums.resize(page + 1);
+    }
+    _page_checksums[page] = page_crc{crc, n};
+}
+
+uint64_t bitio::stream::checksum_length() {
+    if (!backed()) {
+        return _buffer_size;
+    }
+
+    if (_streaming) {
+        return ring_end();
+    }
+
+    // The cached page may be dirty and longer than what is on disk.
+    return data_end() >> 3;
+}
+
+uint32_t bitio::stream::page_checksum(uint64_t page, uint64_t length) {
+    // Pages still in the ring may be appended to after they were recorded, the cached page may be dirty.
+    bool live = _streaming ? page >= _ring_first : page == _buffer_offset && _requires_commit;
+
+    if (!live && page < _page_checksums.size() && _page_checksums[page] && _page_checksums[page]->length == length) {
+        return _page_checksums[page]->crc;
+    }
+
+    uint64_t span;
+    const uint8_t *data = page_for_read(page * _buffer_size, length, span);
+    return crc32c(0, data, span);
+}
+
+uint32_t bitio::stream::checksum() {
+    return checksum(0, checksum_length() << 3);
+}
+
+uint32_t bitio::stream::checksum(uint64_t offset, uint64_t nbits) {
+    uint64_t length = checksum_length();
+    if (offset + nbits > length << 3) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    uint32_t crc = 0;
+
+    if ((offset & 0x7) == 0) {
+        uint64_t byte = offset >> 3;
+        uint64_t nbytes = nbits >> 3;
+
+        while (nbytes) {
+            uint64_t page = backed() ? byte / _buffer_size : 0;
+            uint64_t index = byte - page * _buffer_size;
+            uint64_t page_length = std::min(_buffer_size, length - page * _buffer_size);
+
+            // Whole pages are folded in from their page checksum instead of being hashed again.
+            if (index == 0 && nbytes >= page_length && backed()) {
+                crc = crc32c_combine(crc, page_checksum(page, page_length), page_length);
+                byte += page_length;
+                nbytes -= page_length;
+            } else {
+                uint64_t span;
+                const uint8_t *data = page_for_read(byte, std::min(nbytes, page_length - index), span);
+                crc = crc32c(crc, data, span);
+                byte += span;
+                nbytes -= span;
+            }
+        }
+
+        if (nbits & 0x7) {
+            uint8_t last;
+            read_bytes(byte, &last, 1);
+            last &= u8_lmasks[nbits & 0x7];
+            crc = crc32c(crc, &last, 1);
+        }
+
+        return crc;
+    }
+
+    std::vector<uint8_t> buf(BITIO_CHECKSUM_CHUNK_SIZE + 16);
+
+    while (nbits) {
+        uint64_t m = std::min<uint64_t>(nbits, BITIO_CHECKSUM_CHUNK_SIZE * 8);
+        uint8_t shift = offset & 0x7;
+        uint64_t nbytes = (shift + m + 7) >> 3;
+
+        read_bytes(offset >> 3, buf.data(), nbytes);
+        std::memset(buf.data() + nbytes, 0, 9);
+        kernels().funnel_shift(buf.data(), nbytes, 0, shift);
+
+        uint64_t out = (m + 7) >> 3;
+        if (m & 0x7) {
+            buf[out - 1] &= u8_lmasks[m & 0x7];
+        }
+
+        crc = crc32c(crc, buf.data(), out);
+        offset += m;
+        nbits -= m;
+    }
+
+    return crc;
+}
+
+std::vector<uint32_t> bitio::stream::page_checksums() {
+    uint64_t length = checksum_length();
+    uint64_t page_size = backed() ? _buffer_size : std::max<uint64_t>(length, 1);
+
+    std::vector<uint32_t> checksums;
+    for (uint64_t page = 0; page * page_size < length; page++) {
+        checksums.push_back(page_checksum(page, std::min(page_size, length - page * page_size)));
+    }
+
+    return checksums;
+}
+
+void bitio::stream::verify_checksums(const std::vector<uint32_t> &expected) {
+    _expected_checksums.assign(expected.begin(), expected.end());
+}
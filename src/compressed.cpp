@@ -0,0 +1,170 @@
+#include <bitio/bitio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <bitio/bits.h>
+#include <cstring>
+
+#define BITIO_COMPRESSED_MAGIC 0x424954494f505a31
+#define BITIO_COMPRESSED_TRAILER_SIZE 0x20
+#define BITIO_COMPRESSED_EXTENT_SIZE 0x18
+
+// Layout: encoded page records, then the page table (offset, stored size, raw size per page) and a trailer of
+// table offset, page count, page size and magic, all big-endian.
+void bitio::stream::open_compressed() {
+    int fd = fileno(_file);
+    struct stat st{};
+    ::fstat(fd, &st);
+
+    if (st.st_size == 0) {
+        return;
+    }
+
+    uint8_t trailer[BITIO_COMPRESSED_TRAILER_SIZE];
+    if (st.st_size < BITIO_COMPRESSED_TRAILER_SIZE ||
+        ::pread(fd, trailer, sizeof(trailer), st.st_size - sizeof(trailer)) != sizeof(trailer) ||
+        load_be64(trailer + 24) != BITIO_COMPRESSED_MAGIC) {
+        throw bitio_exception("not a compressed stream");
+    }
+
+    // The table fills the space between the records and the trailer exactly.
+    uint64_t data_end = load_be64(trailer);
+    uint64_t pages = load_be64(trailer + 8);
+    uint64_t page_size = load_be64(trailer + 16);
+    uint64_t table_size = st.st_size - BITIO_COMPRESSED_TRAILER_SIZE;
+    if (page_size == 0 || data_end > table_size || pages != (table_size - data_end) / BITIO_COMPRESSED_EXTENT_SIZE ||
+        (table_size - data_end) % BITIO_COMPRESSED_EXTENT_SIZE) {
+        throw bitio_exception("not a compressed stream");
+    }
+
+    _data_end = data_end;
+    _buffer_size = page_size;
+    _page_table.resize(pages);
+
+    std::vector<uint8_t> table(_page_table.size() * BITIO_COMPRESSED_EXTENT_SIZE);
+    if (::pread(fd, table.data(), table.size(), _data_end) != (ssize_t) table.size()) {
+        throw bitio_exception("not a compressed stream");
+    }
+
+    for (uint64_t i = 0; i < _page_table.size(); i++) {
+        const uint8_t *entry = table.data() + i * BITIO_COMPRESSED_EXTENT_SIZE;
+        _page_table[i] = {load_be64(entry), load_be64(entry + 8), load_be64(entry + 16)};
+
+        page_extent &extent = _page_table[i];
+        if (extent.raw > _buffer_size || extent.stored > _data_end || extent.offset > _data_end - extent.stored) {
+            throw bitio_exception("not a compressed stream");
+        }
+    }
+}
+
+uint64_t bitio::stream::read_extent(int fd, const page_codec *codec, page_extent extent, uint8_t *out,
+                                    std::vector<uint8_t> &scratch) {
+    // Pages that did not shrink are stored as they are.
+    if (extent.stored == extent.raw) {
+        if (::pread(fd, out, extent.raw, extent.offset) != (ssize_t) extent.raw) {
+            throw bitio_exception("corrupt page");
+        }
+        return extent.raw;
+    }
+
+    scratch.resize(extent.stored);
+    if (::pread(fd, scratch.data(), extent.stored, extent.offset) != (ssize_t) extent.stored) {
+        throw bitio_exception("corrupt page");
+    }
+
+    codec->decode(scratch.data(), extent.stored, out, extent.raw);
+    return extent.raw;
+}
+
+void bitio::stream::load_compressed_page(uint64_t offset) {
+    int fd = fileno(_file);
+    bool prefetched = false;
+
+    if (_prefetch.valid()) {
+        uint64_t size = _prefetch.get();
+
+        if (_prefetch_page == offset) {
+            std::swap(_allocation, _prefetch_buffer);
+            _buffer = _allocation;
+            _current_buffer_size = size;
+            prefetched = true;
+        }
+    }
+
+    if (!prefetched) {
+        if (offset < _page_table.size()) {
+            _current_buffer_size = read_extent(fd, _codec, _page_table[offset], _buffer, _scratch);
+        } else {
+            _current_buffer_size = 0;
+        }
+    }
+
+    // Only the last page may be short. Earlier ones were cut off or skipped by a write past the end and the rest
+    // reads as zeros.
+    if (offset + 1 < _page_table.size() && _current_buffer_size < _buffer_size) {
+        std::memset(_buffer + _current_buffer_size, 0, _buffer_size - _current_buffer_size);
+        _current_buffer_size = _buffer_size;
+    }
+
+    // Sequential scans decode the next page in the background while this one is consumed.
+    if ((offset == 0 || offset == _last_loaded + 1) && offset + 1 < _page_table.size()) {
+        page_extent extent = _page_table[offset + 1];
+        const page_codec *codec = _codec;
+        uint8_t *out = _prefetch_buffer;
+
+        _prefetch_page = offset + 1;
+        _prefetch = std::async(std::launch::async, [fd, codec, extent, out]() {
+            std::vector<uint8_t> scratch;
+            return read_extent(fd, codec, extent, out, scratch);
+        });
+    }
+
+    _last_loaded = offset;
+}
+
+void bitio::stream::commit_compressed() {
+    _scratch.resize(_codec->bound(_current_buffer_size));
+    const uint8_t *data = _scratch.data();
+
+    uint64_t stored = _codec->encode(_buffer, _current_buffer_size, _scratch.data());
+    if (stored >= _current_buffer_size) {
+        stored = _current_buffer_size;
+        data = _buffer;
+    }
+
+    if (::pwrite(fileno(_file), data, stored, _data_end) != (ssize_t) stored) {
+        throw bitio_exception("page write-back failed");
+    }
+    _stats.bytes_committed += stored;
+
+    if (_buffer_offset >= _page_table.size()) {
+        _page_table.resize(_buffer_offset + 1, {0, 0, 0});
+    }
+
+    _page_table[_buffer_offset] = {_data_end, stored, _current_buffer_size};
+    _data_end += stored;
+    _table_dirty = true;
+}
+
+void bitio::stream::write_page_table() {
+    std::vector<uint8_t> table(_page_table.size() * BITIO_COMPRESSED_EXTENT_SIZE + BITIO_COMPRESSED_TRAILER_SIZE);
+
+    for (uint64_t i = 0; i < _page_table.size(); i++) {
+        uint8_t *entry = table.data() + i * BITIO_COMPRESSED_EXTENT_SIZE;
+        store_be64(entry, _page_table[i].offset);
+        store_be64(entry + 8, _page_table[i].stored);
+        store_be64(entry + 16, _page_table[i].raw);
+    }
+
+    uint8_t *trailer = table.data() + _page_table.size() * BITIO_COMPRESSED_EXTENT_SIZE;
+    store_be64(trailer, _data_end);
+    store_be64(trailer + 8, _page_table.size());
+    store_be64(trailer + 16, _buffer_size);
+    store_be64(trailer + 24, BITIO_COMPRESSED_MAGIC);
+
+    // The table sits right after the last record, the next commit overwrites it.
+    if (::pwrite(fileno(_file), table.data(), table.size(), _data_end) != (ssize_t) table.size() ||
+        ::ftruncate(fileno(_file), _data_end + table.size()) != 0) {
+        throw bitio_exception("page table write-back failed");
+    }
+    _table_dirty = false;
+}
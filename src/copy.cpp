@@ -0,0 +1,166 @@
+#include <bitio/bitio.h>
+#include <cstring>
+#include <vector>
+#include <bitio/bits.h>
+#include <bitio/cpu.h>
+#include "kernels.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#define BITIO_COPY_CHUNK_SIZE 0x10000
+
+void bitio::impl::funnel_shift_scalar(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift) {
+    funnel_shift(p, n, next, shift);
+}
+
+#if defined(__x86_64__)
+// Byte-wise shifts built from 16-bit ones: the bits crossing into the neighbouring byte of a lane are masked off.
+// Every block reads one byte past itself, which the next block only overwrites after loading it.
+__attribute__((target("avx2")))
+void bitio::impl::funnel_shift_avx2(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift) {
+    __m128i left = _mm_cvtsi32_si128(shift);
+    __m128i right = _mm_cvtsi32_si128(8 - shift);
+    __m256i left_mask = _mm256_set1_epi8(char(0xff << shift));
+    __m256i right_mask = _mm256_set1_epi8(char(0xff >> (8 - shift)));
+
+    uint64_t i = 0;
+    for (; i + 32 < n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (p + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (p + i + 1));
+        __m256i high = _mm256_and_si256(_mm256_sll_epi16(a, left), left_mask);
+        __m256i low = _mm256_and_si256(_mm256_srl_epi16(b, right), right_mask);
+        _mm256_storeu_si256((__m256i *) (p + i), _mm256_or_si256(high, low));
+    }
+
+    funnel_shift(p + i, n - i, next, shift);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void bitio::impl::funnel_shift_avx512(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift) {
+    __m128i left = _mm_cvtsi32_si128(shift);
+    __m128i right = _mm_cvtsi32_si128(8 - shift);
+    __m512i left_mask = _mm512_set1_epi8(char(0xff << shift));
+    __m512i right_mask = _mm512_set1_epi8(char(0xff >> (8 - shift)));
+
+    uint64_t i = 0;
+    for (; i + 64 < n; i += 64) {
+        __m512i a = _mm512_loadu_si512(p + i);
+        __m512i b = _mm512_loadu_si512(p + i + 1);
+        __m512i high = _mm512_and_si512(_mm512_sll_epi16(a, left), left_mask);
+        __m512i low = _mm512_and_si512(_mm512_srl_epi16(b, right), right_mask);
+        _mm512_storeu_si512(p + i, _mm512_or_si512(high, low));
+    }
+
+    funnel_shift_avx2(p + i, n - i, next, shift);
+}
+#endif
+
+void bitio::copy_bits(stream &src, uint64_t src_offset, stream &dst, uint64_t dst_offset, uint64_t nbits) {
+    if (&src == &dst) {
+        move_bits(src, src_offset, dst_offset, nbits);
+        return;
+    }
+
+    // Align the destination to a byte boundary with a regular read/write.
+    uint64_t head = std::min<uint64_t>(nbits, (8 - (dst_offset & 0x7)) & 0x7);
+    if (head) {
+        src.seek_to(src_offset);
+        dst.seek_to(dst_offset);
+        dst.write(src.read(head), head);
+
+        src_offset += head;
+        dst_offset += head;
+        nbits -= head;
+    }
+
+    uint64_t nbytes = nbits >> 3;
+    uint8_t shift = src_offset & 0x7;
+    uint64_t src_byte = src_offset >> 3;
+    uint64_t dst_byte = dst_offset >> 3;
+
+    // Source bytes are copied straight into the destination page; unaligned sources are then shifted in place.
+    auto shift_bits = kernels().funnel_shift;
+    while (nbytes) {
+        uint64_t span;
+        uint8_t *page = dst.page_for_write(dst_byte, nbytes, span);
+        src.read_bytes(src_byte, page, span);
+
+        if (shift) {
+            uint8_t next;
+            src.read_bytes(src_byte + span, &next, 1);
+            shift_bits(page, span, next, shift);
+        }
+
+        src_byte += span;
+        dst_byte += span;
+        nbytes -= span;
+    }
+
+    src_offset = (src_byte << 3) + shift;
+    dst_offset = dst_byte << 3;
+
+    uint8_t tail = nbits & 0x7;
+    src.seek_to(src_offset);
+    dst.seek_to(dst_offset);
+    if (tail) {
+        dst.write(src.read(tail), tail);
+    }
+}
+
+void bitio::move_bits(stream &s, uint64_t from, uint64_t to, uint64_t nbits) {
+    if (from == to || nbits == 0) {
+        s.seek_to(to + nbits);
+        return;
+    }
+
+    std::vector<uint8_t> buf(BITIO_COPY_CHUNK_SIZE + 16);
+    auto shift_bits = kernels().funnel_shift;
+    const uint64_t chunk_bits = BITIO_COPY_CHUNK_SIZE * 8;
+    uint64_t nchunks = (nbits + chunk_bits - 1) / chunk_bits;
+
+    // Each chunk goes through a bounce buffer and is read completely before it is written. Walking the chunks
+    // away from the direction of the move keeps overlapping ranges intact.
+    for (uint64_t c = 0; c < nchunks; c++) {
+        uint64_t chunk = to < from ? c : nchunks - 1 - c;
+        uint64_t m = std::min(chunk_bits, nbits - chunk * chunk_bits);
+        uint64_t src_offset = from + chunk * chunk_bits;
+        uint64_t dst_offset = to + chunk * chunk_bits;
+
+        uint8_t *p = buf.data();
+        uint8_t shift = src_offset & 0x7;
+        uint64_t nbytes = (shift + m + 7) >> 3;
+
+        s.read_bytes(src_offset >> 3, p, nbytes);
+        std::memset(p + nbytes, 0, 9);
+
+        if (shift) {
+            shift_bits(p, nbytes, 0, shift);
+        }
+
+        // Write the bits up to the next destination byte boundary, then realign the buffer to it.
+        uint64_t head = std::min<uint64_t>(m, (8 - (dst_offset & 0x7)) & 0x7);
+        if (head) {
+            s.seek_to(dst_offset);
+            s.write(p[0] >> (8 - head), head);
+
+            uint64_t left = (m + 7) >> 3;
+            shift_bits(p, left, p[left], head);
+
+            dst_offset += head;
+            m -= head;
+        }
+
+        uint64_t full = m >> 3;
+        s.write_bytes(dst_offset >> 3, p, full);
+
+        uint8_t tail = m & 0x7;
+        if (tail) {
+            s.seek_to(dst_offset + (full << 3));
+            s.write(p[full] >> (8 - tail), tail);
+        }
+    }
+
+    s.seek_to(to + nbits);
+}
@@ -0,0 +1,141 @@
+#include <bitio/cpu.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include "kernels.h"
+
+namespace {
+    using namespace bitio::impl;
+
+    constexpr bitio::kernel_table scalar_kernels = {
+            crc32c_scalar,
+            extract_mask_scalar,
+            deposit_mask_scalar,
+            morton2_encode_scalar,
+            morton2_decode_scalar,
+            morton3_encode_scalar,
+            morton3_decode_scalar,
+            funnel_shift_scalar,
+            popcount_scalar,
+            transpose64_scalar
+    };
+
+#if defined(__x86_64__)
+    constexpr bitio::kernel_table sse42_kernels = {
+            crc32c_sse42,
+            extract_mask_scalar,
+            deposit_mask_scalar,
+            morton2_encode_scalar,
+            morton2_decode_scalar,
+            morton3_encode_scalar,
+            morton3_decode_scalar,
+            funnel_shift_scalar,
+            popcount_sse42,
+            transpose64_scalar
+    };
+
+    constexpr bitio::kernel_table avx2_kernels = {
+            crc32c_sse42,
+            extract_mask_bmi2,
+            deposit_mask_bmi2,
+            morton2_encode_bmi2,
+            morton2_decode_bmi2,
+            morton3_encode_bmi2,
+            morton3_decode_bmi2,
+            funnel_shift_avx2,
+            popcount_sse42,
+            transpose64_avx2
+    };
+
+    constexpr bitio::kernel_table avx512_kernels = {
+            crc32c_sse42,
+            extract_mask_bmi2,
+            deposit_mask_bmi2,
+            morton2_encode_bmi2,
+            morton2_decode_bmi2,
+            morton3_encode_bmi2,
+            morton3_decode_bmi2,
+            funnel_shift_avx512,
+            popcount_sse42,
+            transpose64_avx512
+    };
+
+    constexpr const bitio::kernel_table *tables[] = {&scalar_kernels, &sse42_kernels, &avx2_kernels,
+                                                     &avx512_kernels};
+#else
+    constexpr const bitio::kernel_table *tables[] = {&scalar_kernels, &scalar_kernels, &scalar_kernels,
+                                                     &scalar_kernels};
+#endif
+
+    const char *level_names[] = {"scalar", "sse42", "avx2", "avx512"};
+
+    bitio::cpu_level detect() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("sse4.2") || !__builtin_cpu_supports("popcnt")) {
+            return bitio::cpu_level::scalar;
+        }
+
+        if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("bmi") || !__builtin_cpu_supports("bmi2")) {
+            return bitio::cpu_level::sse42;
+        }
+
+        if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw") ||
+            !__builtin_cpu_supports("avx512vl")) {
+            return bitio::cpu_level::avx2;
+        }
+
+        return bitio::cpu_level::avx512;
+#else
+        return bitio::cpu_level::scalar;
+#endif
+    }
+
+    bitio::cpu_level initial_level() {
+        bitio::cpu_level level = bitio::detected_cpu_level();
+
+        const char *forced = std::getenv("BITIO_CPU_LEVEL");
+        if (forced) {
+            for (uint8_t i = 0; i < 4; i++) {
+                if (std::strcmp(forced, level_names[i]) == 0) {
+                    level = std::min(level, bitio::cpu_level(i));
+                }
+            }
+        }
+
+        return level;
+    }
+
+    std::atomic<int> active{-1};
+}
+
+bitio::cpu_level bitio::detected_cpu_level() {
+    static const cpu_level level = detect();
+    return level;
+}
+
+bitio::cpu_level bitio::active_cpu_level() {
+    int level = active.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = int(initial_level());
+        active.store(level, std::memory_order_relaxed);
+    }
+    return cpu_level(level);
+}
+
+void bitio::set_cpu_level(cpu_level level) {
+    active.store(int(std::min(level, detected_cpu_level())), std::memory_order_relaxed);
+}
+
+const char *bitio::cpu_level_name(cpu_level level) {
+    return level_names[uint8_t(level) & 0x3];
+}
+
+const bitio::kernel_table &bitio::kernels() {
+    return *tables[uint8_t(active_cpu_level())];
+}
+
+const bitio::kernel_table &bitio::kernels(cpu_level level) {
+    return *tables[uint8_t(std::min(level, detected_cpu_level()))];
+}
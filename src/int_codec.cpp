@@ -0,0 +1,239 @@
+#include <bitio/int_codec.h>
+#include <bitio/bits.h>
+#include <algorithm>
+#include <bit>
+
+// Block header: encoding, count - 1, width, reference. Patched blocks add the exception count and width.
+#define BITIO_INT_HEADER_BITS (2 + 7 + 7 + 64)
+#define BITIO_INT_PATCH_HEADER_BITS (8 + 7)
+#define BITIO_INT_POSITION_BITS 7
+
+#define BITIO_INT_BATCH_BLOCKS 0x40
+
+namespace {
+    struct block_plan {
+        bitio::int_encoding encoding;
+        uint8_t width;
+        uint64_t reference;
+        uint8_t exception_width;
+        uint64_t exceptions;
+        uint64_t bits;
+    };
+
+    inline uint64_t zigzag(uint64_t d) {
+        return (d << 1) ^ uint64_t(int64_t(d) >> 63);
+    }
+
+    inline uint64_t unzigzag(uint64_t z) {
+        return (z >> 1) ^ -(z & 1);
+    }
+
+    inline uint64_t high_bits(uint64_t v, uint8_t width) {
+        return width < 0x40 ? v >> width : 0;
+    }
+
+    block_plan plan_delta(const uint64_t *values, uint64_t n) {
+        uint64_t any = 0;
+        for (uint64_t i = 1; i < n; i++) {
+            any |= zigzag(values[i] - values[i - 1]);
+        }
+
+        uint8_t width = std::bit_width(any);
+        return {bitio::int_encoding::delta, width, values[0], 0, 0, BITIO_INT_HEADER_BITS + (n - 1) * width};
+    }
+
+    block_plan plan_frame(const uint64_t *values, uint64_t n, bool patched) {
+        auto [lo, hi] = std::minmax_element(values, values + n);
+        uint64_t min = *lo;
+        uint8_t max_width = std::bit_width(*hi - min);
+
+        if (!patched) {
+            return {bitio::int_encoding::frame_of_reference, max_width, min, 0, 0,
+                    BITIO_INT_HEADER_BITS + n * max_width};
+        }
+
+        uint64_t histogram[0x41]{};
+        for (uint64_t i = 0; i < n; i++) {
+            histogram[std::bit_width(values[i] - min)]++;
+        }
+
+        // Every value wider than the chosen width becomes an exception carrying its position and high bits.
+        block_plan best{bitio::int_encoding::patched, max_width, min, 0, 0, UINT64_MAX};
+        uint64_t exceptions = 0;
+        for (int width = max_width; width >= 0; width--) {
+            uint8_t exception_width = max_width - width;
+            uint64_t bits = BITIO_INT_HEADER_BITS + BITIO_INT_PATCH_HEADER_BITS + n * width +
+                            exceptions * (BITIO_INT_POSITION_BITS + exception_width);
+
+            if (bits < best.bits) {
+                best = {bitio::int_encoding::patched, uint8_t(width), min, exception_width, exceptions, bits};
+            }
+            exceptions += histogram[width];
+        }
+
+        return best;
+    }
+
+    block_plan plan(const uint64_t *values, uint64_t n, bitio::int_encoding encoding) {
+        switch (encoding) {
+            case bitio::int_encoding::delta:
+                return plan_delta(values, n);
+            case bitio::int_encoding::frame_of_reference:
+                return plan_frame(values, n, false);
+            case bitio::int_encoding::patched:
+                return plan_frame(values, n, true);
+            default:
+                break;
+        }
+
+        // Ties go to the encodings that are cheaper to decode.
+        block_plan best = plan_frame(values, n, false);
+        for (auto candidate : {plan_delta(values, n), plan_frame(values, n, true)}) {
+            if (candidate.bits < best.bits) {
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    void pack_block(bitio::bit_packer &packer, const uint64_t *values, uint64_t n, const block_plan &p) {
+        packer.put(uint64_t(p.encoding), 2);
+        packer.put(n - 1, 7);
+        packer.put(p.width, 7);
+        packer.put(p.reference, 64);
+
+        if (p.encoding == bitio::int_encoding::delta) {
+            for (uint64_t i = 1; i < n; i++) {
+                packer.put(zigzag(values[i] - values[i - 1]), p.width);
+            }
+            return;
+        }
+
+        uint64_t mask = bitio::low_mask(p.width);
+        if (p.encoding == bitio::int_encoding::patched) {
+            packer.put(p.exceptions, 8);
+            packer.put(p.exception_width, 7);
+        }
+
+        for (uint64_t i = 0; i < n; i++) {
+            packer.put((values[i] - p.reference) & mask, p.width);
+        }
+
+        if (p.encoding == bitio::int_encoding::patched) {
+            for (uint64_t i = 0; i < n; i++) {
+                if (high_bits(values[i] - p.reference, p.width)) {
+                    packer.put(i, BITIO_INT_POSITION_BITS);
+                }
+            }
+
+            for (uint64_t i = 0; i < n; i++) {
+                uint64_t high = high_bits(values[i] - p.reference, p.width);
+                if (high) {
+                    packer.put(high, p.exception_width);
+                }
+            }
+        }
+    }
+
+    inline uint64_t unpack(const uint8_t *p, uint64_t position, uint8_t width) {
+        return width ? bitio::extract_bits(p, position, width) : 0;
+    }
+}
+
+void bitio::write_ints(stream &s, const uint64_t *values, uint64_t n, int_encoding encoding) {
+    s.write(n, 0x40);
+
+    // Worst case block: full width values plus a header.
+    const uint64_t block_bytes = (BITIO_INT_HEADER_BITS + BITIO_INT_PATCH_HEADER_BITS +
+                                  BITIO_INT_BLOCK_SIZE * (0x40 + BITIO_INT_POSITION_BITS)) / 8 + 1;
+    std::vector<uint8_t> buffer(BITIO_INT_BATCH_BLOCKS * block_bytes + 16);
+    uint64_t position = s.position();
+
+    while (n) {
+        bit_packer packer(buffer.data());
+        for (uint64_t b = 0; b < BITIO_INT_BATCH_BLOCKS && n; b++) {
+            uint64_t m = std::min<uint64_t>(n, BITIO_INT_BLOCK_SIZE);
+            pack_block(packer, values, m, plan(values, m, encoding));
+
+            values += m;
+            n -= m;
+        }
+
+        uint64_t nbits = packer.size();
+        packer.finish();
+
+        stream batch(buffer.data(), buffer.size());
+        copy_bits(batch, 0, s, position, nbits);
+        position += nbits;
+    }
+}
+
+std::vector<uint64_t> bitio::read_ints(stream &s) {
+    uint64_t n = s.read(0x40);
+    std::vector<uint64_t> out;
+    std::vector<uint8_t> buffer(BITIO_INT_BLOCK_SIZE * (0x40 + BITIO_INT_POSITION_BITS) / 8 + 16);
+
+    for (uint64_t done = 0; done < n;) {
+        auto encoding = int_encoding(s.read(2));
+        uint64_t count = s.read(7) + 1;
+        uint8_t width = s.read(7);
+        uint64_t reference = s.read(0x40);
+
+        uint64_t exceptions = 0;
+        uint8_t exception_width = 0;
+        if (encoding == int_encoding::patched) {
+            exceptions = s.read(8);
+            exception_width = s.read(7);
+        }
+
+        if (done + count > n || width > 0x40 || exception_width > 0x40 || encoding == int_encoding::best ||
+            exceptions > count ||
+            (exceptions && (width >= 0x40 || exception_width == 0 || width + exception_width > 0x40))) {
+            throw bitio_exception("corrupt integer block");
+        }
+
+        uint64_t values = encoding == int_encoding::delta ? count - 1 : count;
+        uint64_t nbits = values * width + exceptions * (BITIO_INT_POSITION_BITS + exception_width);
+        uint64_t position = s.position();
+
+        if (nbits) {
+            stream body(buffer.data(), buffer.size());
+            copy_bits(s, position, body, 0, nbits);
+        }
+
+        // The count in the header is not trusted with an allocation up front, the output grows with each block.
+        out.resize(done + count);
+        const uint8_t *p = buffer.data();
+        uint64_t *o = out.data() + done;
+
+        if (encoding == int_encoding::delta) {
+            o[0] = reference;
+            for (uint64_t i = 1; i < count; i++) {
+                o[i] = o[i - 1] + unzigzag(unpack(p, (i - 1) * width, width));
+            }
+        } else {
+            for (uint64_t i = 0; i < count; i++) {
+                o[i] = unpack(p, i * width, width);
+            }
+
+            uint64_t positions = count * width;
+            uint64_t highs = positions + exceptions * BITIO_INT_POSITION_BITS;
+            for (uint64_t e = 0; e < exceptions; e++) {
+                uint64_t i = unpack(p, positions + e * BITIO_INT_POSITION_BITS, BITIO_INT_POSITION_BITS);
+                if (i >= count) {
+                    throw bitio_exception("corrupt integer block");
+                }
+                o[i] |= unpack(p, highs + e * exception_width, exception_width) << width;
+            }
+
+            for (uint64_t i = 0; i < count; i++) {
+                o[i] += reference;
+            }
+        }
+
+        s.seek_to(position + nbits);
+        done += count;
+    }
+
+    return out;
+}
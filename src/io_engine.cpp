@@ -0,0 +1,569 @@
+#include <bitio/io_engine.h>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define BITIO_HAS_URING
+#endif
+
+struct bitio::io_engine::ring {
+#ifdef BITIO_HAS_URING
+    int fd{-1};
+    void *sq{};
+    void *cq{};
+    size_t sq_size{};
+    size_t cq_size{};
+    io_uring_sqe *sqes{};
+    size_t sqes_size{};
+
+    uint32_t *sq_head{};
+    uint32_t *sq_tail{};
+    uint32_t *sq_mask{};
+    uint32_t *sq_array{};
+    uint32_t *cq_head{};
+    uint32_t *cq_tail{};
+    uint32_t *cq_mask{};
+    io_uring_cqe *cqes{};
+
+    ~ring() {
+        if (sqes) {
+            ::munmap(sqes, sqes_size);
+        }
+        if (cq && cq != sq) {
+            ::munmap(cq, cq_size);
+        }
+        if (sq) {
+            ::munmap(sq, sq_size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    static void *map(int fd, size_t size, uint64_t offset) {
+        void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    static std::unique_ptr<ring> open(uint32_t entries) {
+        io_uring_params params{};
+        int fd = (int) ::syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        auto r = std::make_unique<ring>();
+        r->fd = fd;
+        r->sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        r->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        r->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) {
+            r->sq_size = r->cq_size = std::max(r->sq_size, r->cq_size);
+        }
+
+        r->sq = map(fd, r->sq_size, IORING_OFF_SQ_RING);
+        r->cq = single ? r->sq : map(fd, r->cq_size, IORING_OFF_CQ_RING);
+        r->sqes = (io_uring_sqe *) map(fd, r->sqes_size, IORING_OFF_SQES);
+        if (!r->sq || !r->cq || !r->sqes) {
+            return nullptr;
+        }
+
+        auto sq = (uint8_t *) r->sq;
+        auto cq = (uint8_t *) r->cq;
+        r->sq_head = (uint32_t *) (sq + params.sq_off.head);
+        r->sq_tail = (uint32_t *) (sq + params.sq_off.tail);
+        r->sq_mask = (uint32_t *) (sq + params.sq_off.ring_mask);
+        r->sq_array = (uint32_t *) (sq + params.sq_off.array);
+        r->cq_head = (uint32_t *) (cq + params.cq_off.head);
+        r->cq_tail = (uint32_t *) (cq + params.cq_off.tail);
+        r->cq_mask = (uint32_t *) (cq + params.cq_off.ring_mask);
+        r->cqes = (io_uring_cqe *) (cq + params.cq_off.cqes);
+        return r;
+    }
+
+    void push(uint8_t opcode, int file, uint8_t *buffer, uint64_t length, uint64_t position, uint64_t data,
+              bool link) {
+        uint32_t tail = *sq_tail;
+        uint32_t index = tail & *sq_mask;
+
+        io_uring_sqe &sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = file;
+        sqe.addr = (uint64_t) buffer;
+        sqe.len = length;
+        sqe.off = position;
+        sqe.user_data = data;
+        sqe.flags = link ? IOSQE_IO_LINK : 0;
+
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    void push_write(int file, uint8_t *buffer, uint64_t length, uint64_t position, uint64_t data, bool link) {
+        push(IORING_OP_WRITE, file, buffer, length, position, data, link);
+    }
+
+    void push_read(int file, uint8_t *buffer, uint64_t length, uint64_t position, uint64_t data) {
+        push(IORING_OP_READ, file, buffer, length, position, data, false);
+    }
+
+    // Submits everything the kernel has not consumed yet and optionally waits for a completion.
+    void enter(bool wait) {
+        uint32_t submit = *sq_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        while (::syscall(__NR_io_uring_enter, fd, submit, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0,
+                         nullptr, 0) < 0 && errno == EINTR) {}
+    }
+
+    template<typename F>
+    void reap(F &&f) {
+        uint32_t head = *cq_head;
+        uint32_t tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; head++) {
+            const io_uring_cqe &cqe = cqes[head & *cq_mask];
+            f(cqe.user_data, cqe.res);
+        }
+
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return *cq_head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    }
+#else
+    static std::unique_ptr<ring> open(uint32_t) {
+        return nullptr;
+    }
+
+    void push_write(int, uint8_t *, uint64_t, uint64_t, uint64_t, bool) {}
+
+    void push_read(int, uint8_t *, uint64_t, uint64_t, uint64_t) {}
+
+    void enter(bool) {}
+
+    template<typename F>
+    void reap(F &&) {}
+
+    [[nodiscard]] bool empty() const {
+        return true;
+    }
+#endif
+};
+
+bitio::io_engine::io_engine(uint32_t queue_depth, uint32_t flags) {
+    // A page miss takes two transfers, the write-back of the dirty page and the read of the new one.
+    _depth = std::max<uint32_t>(queue_depth, 2);
+
+    if (!(flags & BITIO_ENGINE_NO_URING)) {
+        _ring = ring::open(_depth);
+    }
+
+    if (!_ring) {
+        for (uint32_t i = 0; i < BITIO_ENGINE_THREADS; i++) {
+            _workers.emplace_back([this]() { work(); });
+        }
+    }
+}
+
+bitio::io_engine::~io_engine() {
+    // The kernel or the workers may still be writing into stream buffers.
+    while (_transfers) {
+        reap(true);
+    }
+
+    while (!_completed.empty()) {
+        complete(std::move(_completed.front()), false);
+        _completed.pop_front();
+    }
+
+    for (auto &entry : _streams) {
+        entry.first->_engine = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _work_cv.notify_all();
+
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+void bitio::io_engine::work() {
+    for (;;) {
+        request *r;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_cv.wait(lock, [this]() { return _stop || !_work.empty(); });
+            if (_work.empty()) {
+                return;
+            }
+
+            r = _work.front();
+            _work.pop_front();
+        }
+
+        if (r->write_length) {
+            r->write_result = ::pwrite(r->fd, r->buffer, r->write_length, r->write_position);
+        }
+
+        // The page buffer is still dirty when the write-back failed, so it must not be overwritten.
+        if (r->load && r->write_result >= int64_t(r->write_length)) {
+            r->read_result = ::pread(r->fd, r->buffer, r->read_length, r->read_position);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done.push_back(r);
+        }
+        _done_cv.notify_one();
+    }
+}
+
+void bitio::io_engine::attach(stream &s) {
+    if (s._streaming || s._codec || s._streambuf || !s.backed()) {
+        throw bitio_exception("io_engine: only plain file streams can be attached");
+    }
+
+    if (s._engine) {
+        throw bitio_exception("io_engine: stream is already attached");
+    }
+
+    // From here on the stream bypasses stdio, so nothing may be left in its buffer.
+    if (s._file) {
+        std::fflush(s._file);
+    }
+
+    s._engine = this;
+    _streams[&s] = false;
+}
+
+void bitio::io_engine::detach(stream &s) {
+    auto it = _streams.find(&s);
+    if (it == _streams.end()) {
+        return;
+    }
+
+    if (it->second) {
+        throw bitio_exception("io_engine: cannot detach a stream with a request in flight");
+    }
+
+    s.flush();
+    _streams.erase(it);
+    s._engine = nullptr;
+}
+
+void bitio::io_engine::drop(stream &s) {
+    auto it = _streams.find(&s);
+    if (it == _streams.end()) {
+        return;
+    }
+
+    // The coroutine waiting on a dropped request is never resumed.
+    std::erase_if(_queued, [&s](const std::unique_ptr<request> &r) { return r->s == &s; });
+
+    auto in_flight = [this, &s]() {
+        return std::any_of(_in_flight.begin(), _in_flight.end(), [&s](const auto &entry) {
+            return entry.second->s == &s;
+        });
+    };
+    while (in_flight()) {
+        reap(true);
+    }
+
+    for (auto r = _completed.begin(); r != _completed.end();) {
+        if ((*r)->s != &s) {
+            r++;
+            continue;
+        }
+
+        complete(std::move(*r), false);
+        r = _completed.erase(r);
+    }
+
+    try {
+        s.flush();
+    } catch (bitio_exception &) {}
+
+    _streams.erase(it);
+    s._engine = nullptr;
+}
+
+bool bitio::io_engine::uring() const {
+    return _ring != nullptr;
+}
+
+void bitio::io_engine::submit(std::function<void()> job, std::coroutine_handle<> handle) {
+    _ready.emplace_back(std::move(job), handle);
+}
+
+void bitio::io_engine::submit_load(stream &s, uint64_t page, completion job, std::coroutine_handle<> handle) {
+    enqueue(s, true, page, std::move(job), handle);
+}
+
+void bitio::io_engine::submit_writeback(stream &s, completion job, std::coroutine_handle<> handle) {
+    enqueue(s, false, 0, std::move(job), handle);
+}
+
+void bitio::io_engine::enqueue(stream &s, bool load, uint64_t page, completion job,
+                               std::coroutine_handle<> handle) {
+    auto it = _streams.find(&s);
+    if (it == _streams.end()) {
+        throw bitio_exception("io_engine: stream is not attached");
+    }
+
+    if (it->second) {
+        throw bitio_exception("io_engine: stream already has a request in flight");
+    }
+
+    auto r = std::make_unique<request>();
+    r->s = &s;
+    r->job = std::move(job);
+    r->handle = handle;
+    r->fd = s.io_fd();
+    r->buffer = s._buffer;
+
+    if (s._requires_commit) {
+        if (s._checksums) {
+            s.record_checksum(s._buffer_offset, s._buffer, s._current_buffer_size, false);
+        }
+
+        r->write_position = s._buffer_offset * s._buffer_size;
+        r->write_length = s.writeback_length();
+    }
+
+    if (load) {
+        r->load = true;
+        r->page = page;
+        r->read_position = page * s._buffer_size;
+        r->read_length = s._buffer_size;
+    }
+
+    it->second = true;
+    _queued.push_back(std::move(r));
+}
+
+void bitio::io_engine::dispatch() {
+    bool submitted = false;
+
+    while (!_queued.empty()) {
+        request *r = _queued.front().get();
+        uint32_t transfers = (r->write_length ? 1 : 0) + (r->load ? 1 : 0);
+        if (_transfers + transfers > _depth) {
+            break;
+        }
+
+        std::unique_ptr<request> owned = std::move(_queued.front());
+        _queued.pop_front();
+
+        if (!transfers) {
+            _completed.push_back(std::move(owned));
+            continue;
+        }
+
+        r->remaining = transfers;
+        _transfers += transfers;
+        _in_flight[r] = std::move(owned);
+
+        if (!_ring) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _work.push_back(r);
+            }
+            _work_cv.notify_one();
+            continue;
+        }
+
+        // The read is linked behind the write-back since both use the same page buffer. The low bit of the
+        // completion data tells the two apart.
+        if (r->write_length) {
+            _ring->push_write(r->fd, r->buffer, r->write_length, r->write_position, (uint64_t) r, r->load);
+        }
+
+        if (r->load) {
+            _ring->push_read(r->fd, r->buffer, r->read_length, r->read_position, (uint64_t) r | 1);
+        }
+        submitted = true;
+    }
+
+    if (submitted) {
+        _ring->enter(false);
+    }
+}
+
+void bitio::io_engine::reap(bool block) {
+    if (_ring) {
+        if (block && _transfers && _ring->empty()) {
+            _ring->enter(true);
+        }
+
+        _ring->reap([this](uint64_t data, int32_t result) {
+            auto r = (request *) (data & ~uint64_t(1));
+            if (data & 1) {
+                r->read_result = result;
+            } else {
+                r->write_result = result;
+            }
+            finish(r, 1);
+        });
+        return;
+    }
+
+    std::deque<request *> done;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (block && _transfers) {
+            _done_cv.wait(lock, [this]() { return !_done.empty(); });
+        }
+        done.swap(_done);
+    }
+
+    for (auto r : done) {
+        finish(r, r->remaining);
+    }
+}
+
+void bitio::io_engine::finish(request *r, uint32_t transfers) {
+    _transfers -= transfers;
+    r->remaining -= transfers;
+
+    if (!r->remaining) {
+        auto it = _in_flight.find(r);
+        _completed.push_back(std::move(it->second));
+        _in_flight.erase(it);
+    }
+}
+
+std::exception_ptr bitio::io_engine::complete(std::unique_ptr<request> r, bool resume) {
+    std::exception_ptr error;
+    stream &s = *r->s;
+
+    try {
+        // A failed or short write-back leaves the page dirty and skips the load, the read linked behind it was
+        // cancelled anyway.
+        if (r->write_length && r->write_result != int64_t(r->write_length)) {
+            throw bitio_exception("io_engine: page write-back failed");
+        }
+
+        if (r->write_length) {
+            s._stats.page_commits++;
+            s._stats.bytes_committed += r->write_length;
+            s.finish_writeback(r->write_length);
+        }
+
+        if (r->load) {
+            // A failed write-back cancels the linked read.
+            if (r->read_result < 0) {
+                r->read_result = ::pread(r->fd, r->buffer, r->read_length, r->read_position);
+            }
+            s.install_page(r->page, r->read_result);
+            s._stats.page_loads++;
+            s._stats.bytes_loaded += s._current_buffer_size;
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    auto it = _streams.find(&s);
+    if (it != _streams.end()) {
+        it->second = false;
+    }
+
+    if (resume && r->handle) {
+        r->job(error);
+        r->handle.resume();
+    }
+    return error;
+}
+
+uint64_t bitio::io_engine::poll() {
+    reap(false);
+
+    std::deque<std::unique_ptr<request>> completed;
+    std::deque<std::pair<std::function<void()>, std::coroutine_handle<>>> ready;
+    completed.swap(_completed);
+    ready.swap(_ready);
+
+    for (auto &r : completed) {
+        complete(std::move(r), true);
+    }
+
+    for (auto &[job, handle] : ready) {
+        job();
+        handle.resume();
+    }
+
+    // Requests queued by the coroutines resumed above go out together.
+    dispatch();
+    return completed.size() + ready.size();
+}
+
+uint64_t bitio::io_engine::wait() {
+    dispatch();
+
+    if (_completed.empty() && _ready.empty()) {
+        reap(true);
+    }
+
+    return poll();
+}
+
+uint64_t bitio::io_engine::pending() const {
+    return _queued.size() + _in_flight.size() + _completed.size() + _ready.size();
+}
+
+void bitio::io_engine::flush() {
+    for (auto &[s, busy] : _streams) {
+        if (!busy && s->_requires_commit) {
+            enqueue(*s, false, 0, nullptr, nullptr);
+            _flushing++;
+        }
+    }
+
+    std::exception_ptr error;
+    while (_flushing) {
+        dispatch();
+        reap(true);
+
+        for (auto it = _completed.begin(); it != _completed.end();) {
+            if ((*it)->handle) {
+                it++;
+                continue;
+            }
+
+            auto failed = complete(std::move(*it), false);
+            error = error ? error : failed;
+            it = _completed.erase(it);
+            _flushing--;
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+int bitio::stream::io_fd() const {
+    return _fd >= 0 ? _fd : fileno(_file);
+}
+
+void bitio::stream::install_page(uint64_t offset, int64_t n) {
+    _buffer_offset = offset;
+    _current_buffer_size = n > 0 ? n : 0;
+    pad_page();
+
+    if (_checksums) {
+        record_checksum(offset, _buffer, _current_buffer_size, true);
+    }
+}
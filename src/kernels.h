@@ -0,0 +1,56 @@
+#ifndef BITIO_KERNELS_H
+#define BITIO_KERNELS_H
+
+#include <bitio/cpu.h>
+
+// Implementations collected into the kernel tables by cpu.cpp. The x86 variants are compiled with target
+// attributes and must only be called through a table of a level the CPU supports.
+namespace bitio::impl {
+    uint32_t crc32c_scalar(uint32_t crc, const uint8_t *data, uint64_t n);
+
+    uint64_t extract_mask_scalar(uint64_t value, uint64_t mask);
+
+    uint64_t deposit_mask_scalar(uint64_t value, uint64_t mask);
+
+    void morton2_encode_scalar(const uint32_t *x, const uint32_t *y, uint64_t *codes, uint64_t n);
+
+    void morton2_decode_scalar(const uint64_t *codes, uint32_t *x, uint32_t *y, uint64_t n);
+
+    void morton3_encode_scalar(const uint32_t *x, const uint32_t *y, const uint32_t *z, uint64_t *codes, uint64_t n);
+
+    void morton3_decode_scalar(const uint64_t *codes, uint32_t *x, uint32_t *y, uint32_t *z, uint64_t n);
+
+    void funnel_shift_scalar(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift);
+
+    uint64_t popcount_scalar(const uint64_t *words, uint64_t n);
+
+    void transpose64_scalar(uint64_t *rows);
+
+#if defined(__x86_64__)
+    uint32_t crc32c_sse42(uint32_t crc, const uint8_t *data, uint64_t n);
+
+    uint64_t popcount_sse42(const uint64_t *words, uint64_t n);
+
+    uint64_t extract_mask_bmi2(uint64_t value, uint64_t mask);
+
+    uint64_t deposit_mask_bmi2(uint64_t value, uint64_t mask);
+
+    void morton2_encode_bmi2(const uint32_t *x, const uint32_t *y, uint64_t *codes, uint64_t n);
+
+    void morton2_decode_bmi2(const uint64_t *codes, uint32_t *x, uint32_t *y, uint64_t n);
+
+    void morton3_encode_bmi2(const uint32_t *x, const uint32_t *y, const uint32_t *z, uint64_t *codes, uint64_t n);
+
+    void morton3_decode_bmi2(const uint64_t *codes, uint32_t *x, uint32_t *y, uint32_t *z, uint64_t n);
+
+    void funnel_shift_avx2(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift);
+
+    void funnel_shift_avx512(uint8_t *p, uint64_t n, uint8_t next, uint8_t shift);
+
+    void transpose64_avx2(uint64_t *rows);
+
+    void transpose64_avx512(uint64_t *rows);
+#endif
+}
+
+#endif
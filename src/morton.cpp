@@ -0,0 +1,230 @@
+#include <bitio/morton.h>
+#include <bitio/cpu.h>
+#include "kernels.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#define BITIO_MORTON2_X 0x5555555555555555ull
+#define BITIO_MORTON3_X 0x1249249249249249ull
+#define BITIO_MORTON3_MASK 0x1fffff
+
+namespace {
+    // Byte-wise spread and compact tables for the fallbacks. A code byte holds 4 bits of each 2D coordinate,
+    // 9 code bits hold 3 bits of each 3D coordinate.
+    struct morton_tables {
+        uint16_t spread2[256]{};
+        uint32_t spread3[256]{};
+        uint8_t compact2[256]{};
+        uint16_t compact3[512]{};
+
+        morton_tables() {
+            for (uint32_t v = 0; v < 256; v++) {
+                for (uint32_t b = 0; b < 8; b++) {
+                    spread2[v] |= ((v >> b) & 1) << (2 * b);
+                    spread3[v] |= ((v >> b) & 1) << (3 * b);
+                }
+
+                for (uint32_t b = 0; b < 8; b++) {
+                    compact2[v] |= ((v >> b) & 1) << ((b >> 1) + (b & 1) * 4);
+                }
+            }
+
+            for (uint32_t v = 0; v < 512; v++) {
+                for (uint32_t b = 0; b < 9; b++) {
+                    compact3[v] |= ((v >> b) & 1) << (b / 3 + (b % 3) * 3);
+                }
+            }
+        }
+    };
+
+    const morton_tables tables;
+
+    inline uint64_t morton2_encode_one(uint32_t x, uint32_t y) {
+        uint64_t code = 0;
+        for (int k = 0; k < 4; k++) {
+            uint64_t lane = tables.spread2[(x >> (8 * k)) & 0xff] | (tables.spread2[(y >> (8 * k)) & 0xff] << 1);
+            code |= lane << (16 * k);
+        }
+        return code;
+    }
+
+    inline void morton2_decode_one(uint64_t code, uint32_t &x, uint32_t &y) {
+        x = 0;
+        y = 0;
+        for (int k = 0; k < 8; k++) {
+            uint8_t c = tables.compact2[(code >> (8 * k)) & 0xff];
+            x |= uint32_t(c & 0xf) << (4 * k);
+            y |= uint32_t(c >> 4) << (4 * k);
+        }
+    }
+
+    inline uint64_t morton3_encode_one(uint32_t x, uint32_t y, uint32_t z) {
+        uint64_t code = 0;
+        for (int k = 0; k < 3; k++) {
+            uint64_t lane = tables.spread3[(x >> (8 * k)) & 0xff] |
+                            (uint64_t(tables.spread3[(y >> (8 * k)) & 0xff]) << 1) |
+                            (uint64_t(tables.spread3[(z >> (8 * k)) & 0xff]) << 2);
+            code |= lane << (24 * k);
+        }
+        return code;
+    }
+
+    inline void morton3_decode_one(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z) {
+        x = 0;
+        y = 0;
+        z = 0;
+        for (int k = 0; k < 7; k++) {
+            uint16_t c = tables.compact3[(code >> (9 * k)) & 0x1ff];
+            x |= uint32_t(c & 0x7) << (3 * k);
+            y |= uint32_t((c >> 3) & 0x7) << (3 * k);
+            z |= uint32_t(c >> 6) << (3 * k);
+        }
+    }
+}
+
+uint64_t bitio::impl::extract_mask_scalar(uint64_t value, uint64_t mask) {
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1) {
+        if (value & mask & -mask) {
+            result |= bit;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+uint64_t bitio::impl::deposit_mask_scalar(uint64_t value, uint64_t mask) {
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1) {
+        if (value & bit) {
+            result |= mask & -mask;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+void bitio::impl::morton2_encode_scalar(const uint32_t *x, const uint32_t *y, uint64_t *codes, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        codes[i] = morton2_encode_one(x[i], y[i]);
+    }
+}
+
+void bitio::impl::morton2_decode_scalar(const uint64_t *codes, uint32_t *x, uint32_t *y, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        morton2_decode_one(codes[i], x[i], y[i]);
+    }
+}
+
+void bitio::impl::morton3_encode_scalar(const uint32_t *x, const uint32_t *y, const uint32_t *z, uint64_t *codes,
+                                        uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        codes[i] = morton3_encode_one(x[i] & BITIO_MORTON3_MASK, y[i] & BITIO_MORTON3_MASK, z[i] & BITIO_MORTON3_MASK);
+    }
+}
+
+void bitio::impl::morton3_decode_scalar(const uint64_t *codes, uint32_t *x, uint32_t *y, uint32_t *z, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        morton3_decode_one(codes[i], x[i], y[i], z[i]);
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("bmi2")))
+uint64_t bitio::impl::extract_mask_bmi2(uint64_t value, uint64_t mask) {
+    return _pext_u64(value, mask);
+}
+
+__attribute__((target("bmi2")))
+uint64_t bitio::impl::deposit_mask_bmi2(uint64_t value, uint64_t mask) {
+    return _pdep_u64(value, mask);
+}
+
+// pdep only takes as many low bits as the mask has set, so 3D coordinates need no masking here.
+__attribute__((target("bmi2")))
+void bitio::impl::morton2_encode_bmi2(const uint32_t *x, const uint32_t *y, uint64_t *codes, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        codes[i] = _pdep_u64(x[i], BITIO_MORTON2_X) | _pdep_u64(y[i], BITIO_MORTON2_X << 1);
+    }
+}
+
+__attribute__((target("bmi2")))
+void bitio::impl::morton2_decode_bmi2(const uint64_t *codes, uint32_t *x, uint32_t *y, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        x[i] = _pext_u64(codes[i], BITIO_MORTON2_X);
+        y[i] = _pext_u64(codes[i], BITIO_MORTON2_X << 1);
+    }
+}
+
+__attribute__((target("bmi2")))
+void bitio::impl::morton3_encode_bmi2(const uint32_t *x, const uint32_t *y, const uint32_t *z, uint64_t *codes,
+                                      uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        codes[i] = _pdep_u64(x[i], BITIO_MORTON3_X) | _pdep_u64(y[i], BITIO_MORTON3_X << 1) |
+                   _pdep_u64(z[i], BITIO_MORTON3_X << 2);
+    }
+}
+
+__attribute__((target("bmi2")))
+void bitio::impl::morton3_decode_bmi2(const uint64_t *codes, uint32_t *x, uint32_t *y, uint32_t *z, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        x[i] = _pext_u64(codes[i], BITIO_MORTON3_X);
+        y[i] = _pext_u64(codes[i], BITIO_MORTON3_X << 1);
+        z[i] = _pext_u64(codes[i], BITIO_MORTON3_X << 2);
+    }
+}
+#endif
+
+uint64_t bitio::extract_mask(uint64_t value, uint64_t mask) {
+    return kernels().extract_mask(value, mask);
+}
+
+uint64_t bitio::deposit_mask(uint64_t value, uint64_t mask) {
+    return kernels().deposit_mask(value, mask);
+}
+
+uint64_t bitio::read_extract(stream &s, uint8_t n, uint64_t mask) {
+    return extract_mask(s.read(n), mask);
+}
+
+void bitio::write_deposit(stream &s, uint64_t value, uint64_t mask, uint8_t n) {
+    s.write(deposit_mask(value, mask), n);
+}
+
+uint64_t bitio::morton2_encode(uint32_t x, uint32_t y) {
+    uint64_t code;
+    kernels().morton2_encode(&x, &y, &code, 1);
+    return code;
+}
+
+void bitio::morton2_decode(uint64_t code, uint32_t &x, uint32_t &y) {
+    kernels().morton2_decode(&code, &x, &y, 1);
+}
+
+uint64_t bitio::morton3_encode(uint32_t x, uint32_t y, uint32_t z) {
+    uint64_t code;
+    kernels().morton3_encode(&x, &y, &z, &code, 1);
+    return code;
+}
+
+void bitio::morton3_decode(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z) {
+    kernels().morton3_decode(&code, &x, &y, &z, 1);
+}
+
+void bitio::morton2_encode(const uint32_t *x, const uint32_t *y, uint64_t *codes, uint64_t n) {
+    kernels().morton2_encode(x, y, codes, n);
+}
+
+void bitio::morton2_decode(const uint64_t *codes, uint32_t *x, uint32_t *y, uint64_t n) {
+    kernels().morton2_decode(codes, x, y, n);
+}
+
+void bitio::morton3_encode(const uint32_t *x, const uint32_t *y, const uint32_t *z, uint64_t *codes, uint64_t n) {
+    kernels().morton3_encode(x, y, z, codes, n);
+}
+
+void bitio::morton3_decode(const uint64_t *codes, uint32_t *x, uint32_t *y, uint32_t *z, uint64_t n) {
+    kernels().morton3_decode(codes, x, y, z, n);
+}
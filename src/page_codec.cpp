@@ -0,0 +1,133 @@
+#include <bitio/bitio.h>
+#include <bitio/page_codec.h>
+#include <cstring>
+
+#define BITIO_RLE_MIN_RUN 0x4
+
+namespace {
+    inline uint64_t put_varint(uint8_t *out, uint64_t v) {
+        uint64_t n = 0;
+        while (v >= 0x80) {
+            out[n++] = (v & 0x7f) | 0x80;
+            v >>= 7;
+        }
+        out[n++] = v;
+        return n;
+    }
+
+    inline uint64_t get_varint(const uint8_t *in, uint64_t n, uint64_t &pos) {
+        uint64_t v = 0;
+        for (uint8_t shift = 0; shift < 64; shift += 7) {
+            if (pos >= n) {
+                break;
+            }
+
+            uint8_t b = in[pos++];
+            v |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return v;
+            }
+        }
+
+        throw bitio::bitio_exception("corrupt page");
+    }
+
+    // Tokens are varint(length << 1 | is_run), followed by the literal bytes or the repeated byte.
+    class rle_codec_impl : public bitio::page_codec {
+    private:
+        static uint64_t run_end(const uint8_t *in, uint64_t i, uint64_t n) {
+            uint64_t pattern = 0x0101010101010101ull * in[i];
+            uint64_t j = i + 1;
+
+            while (j + 8 <= n) {
+                uint64_t word;
+                std::memcpy(&word, in + j, 8);
+                if (word != pattern) {
+                    break;
+                }
+                j += 8;
+            }
+
+            while (j < n && in[j] == in[i]) {
+                j++;
+            }
+
+            return j;
+        }
+
+        static uint64_t put_literals(const uint8_t *in, uint64_t n, uint8_t *out) {
+            if (n == 0) {
+                return 0;
+            }
+
+            uint64_t o = put_varint(out, n << 1);
+            std::memcpy(out + o, in, n);
+            return o + n;
+        }
+
+    public:
+        [[nodiscard]] uint64_t bound(uint64_t n) const override {
+            return n + (n >> 6) + 16;
+        }
+
+        uint64_t encode(const uint8_t *in, uint64_t n, uint8_t *out) const override {
+            uint64_t o = 0;
+            uint64_t literal = 0;
+            uint64_t i = 0;
+
+            while (i < n) {
+                uint64_t j = run_end(in, i, n);
+
+                if (j - i >= BITIO_RLE_MIN_RUN) {
+                    o += put_literals(in + literal, i - literal, out + o);
+                    o += put_varint(out + o, ((j - i) << 1) | 1);
+                    out[o++] = in[i];
+                    literal = j;
+                }
+
+                i = j;
+            }
+
+            o += put_literals(in + literal, n - literal, out + o);
+            return o;
+        }
+
+        void decode(const uint8_t *in, uint64_t n, uint8_t *out, uint64_t raw) const override {
+            uint64_t pos = 0;
+            uint64_t o = 0;
+
+            while (pos < n) {
+                uint64_t token = get_varint(in, n, pos);
+                uint64_t length = token >> 1;
+
+                if (length > raw - o) {
+                    throw bitio::bitio_exception("corrupt page");
+                }
+
+                if (token & 1) {
+                    if (pos >= n) {
+                        throw bitio::bitio_exception("corrupt page");
+                    }
+                    std::memset(out + o, in[pos++], length);
+                } else {
+                    if (length > n - pos) {
+                        throw bitio::bitio_exception("corrupt page");
+                    }
+                    std::memcpy(out + o, in + pos, length);
+                    pos += length;
+                }
+
+                o += length;
+            }
+
+            if (o != raw) {
+                throw bitio::bitio_exception("corrupt page");
+            }
+        }
+    };
+}
+
+bitio::page_codec *bitio::rle_codec() {
+    static auto *instance = new rle_codec_impl();
+    return instance;
+}
@@ -0,0 +1,277 @@
+#include <bitio/rank_select.h>
+#include <bitio/cpu.h>
+#include <algorithm>
+#include <bit>
+#include "kernels.h"
+
+uint64_t bitio::impl::popcount_scalar(const uint64_t *words, uint64_t n) {
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        count += std::popcount(words[i]);
+    }
+    return count;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("popcnt")))
+uint64_t bitio::impl::popcount_sse42(const uint64_t *words, uint64_t n) {
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        count += __builtin_popcountll(words[i]);
+    }
+    return count;
+}
+#endif
+
+static inline uint64_t select_in_word(uint64_t word, uint64_t k) {
+    // Bits are MSB-first, so walk down from the top byte before narrowing to a single bit.
+    uint64_t pos = 0;
+    for (uint8_t shift = 56;; shift -= 8) {
+        uint64_t count = std::popcount((word >> shift) & 0xff);
+        if (k < count) {
+            break;
+        }
+        k -= count;
+        pos += 8;
+    }
+
+    uint8_t byte = (word >> (56 - pos)) & 0xff;
+    for (uint8_t i = 0; i < 8; i++) {
+        if (byte & (0x80 >> i)) {
+            if (k == 0) {
+                return pos + i;
+            }
+            k--;
+        }
+    }
+
+    return pos;
+}
+
+bitio::rank_select::rank_select(stream &s, uint64_t offset, uint64_t nbits) {
+    _size = nbits;
+    read_words(s, offset);
+
+    uint64_t nblocks = (_size + BITIO_RS_BLOCK_BITS - 1) / BITIO_RS_BLOCK_BITS;
+    uint64_t nsuperblocks = (_size + BITIO_RS_SUPERBLOCK_BITS - 1) / BITIO_RS_SUPERBLOCK_BITS;
+
+    _blocks.resize(nblocks);
+    _superblocks.resize(nsuperblocks + 1);
+
+    uint64_t total = 0;
+    uint64_t relative = 0;
+    auto popcount = kernels().popcount;
+
+    for (uint64_t b = 0; b < nblocks; b++) {
+        if (b % (BITIO_RS_SUPERBLOCK_BITS / BITIO_RS_BLOCK_BITS) == 0) {
+            _superblocks[b / (BITIO_RS_SUPERBLOCK_BITS / BITIO_RS_BLOCK_BITS)] = total;
+            relative = 0;
+        }
+
+        _blocks[b] = relative;
+
+        uint64_t first = b * (BITIO_RS_BLOCK_BITS / 64);
+        uint64_t count = popcount(&_words[first], std::min<uint64_t>(BITIO_RS_BLOCK_BITS / 64, _words.size() - first));
+        total += count;
+        relative += count;
+    }
+
+    _superblocks[nsuperblocks] = total;
+    _ones = total;
+
+    build_samples();
+}
+
+void bitio::rank_select::read_words(stream &s, uint64_t offset) {
+    _words.resize((_size + 63) >> 6);
+    s.seek_to(offset);
+
+    uint64_t full = _size >> 6;
+    for (uint64_t i = 0; i < full; i++) {
+        _words[i] = s.read(0x40);
+    }
+
+    uint8_t tail = _size & 0x3f;
+    if (tail) {
+        _words[full] = s.read(tail) << (0x40 - tail);
+    }
+}
+
+void bitio::rank_select::build_samples() {
+    _select_samples.clear();
+    uint64_t nsuperblocks = _superblocks.size() - 1;
+    uint64_t sb = 0;
+
+    for (uint64_t k = 0; k < _ones; k += BITIO_RS_SELECT_SAMPLE) {
+        while (sb + 1 < nsuperblocks && _superblocks[sb + 1] <= k) {
+            sb++;
+        }
+        _select_samples.push_back(sb);
+    }
+
+    _select_samples.push_back(nsuperblocks ? nsuperblocks - 1 : 0);
+}
+
+uint64_t bitio::rank_select::zeros_before_superblock(uint64_t sb) const {
+    return sb * BITIO_RS_SUPERBLOCK_BITS - _superblocks[sb];
+}
+
+uint64_t bitio::rank_select::rank1(uint64_t i) const {
+    if (i >= _size) {
+        if (i > _size) {
+            throw bitio_exception("rank_select: position out of range");
+        }
+        return _ones;
+    }
+
+    uint64_t word = i >> 6;
+    uint64_t block = i / BITIO_RS_BLOCK_BITS;
+    uint64_t rank = _superblocks[i / BITIO_RS_SUPERBLOCK_BITS] + _blocks[block];
+
+    for (uint64_t w = block * (BITIO_RS_BLOCK_BITS / 64); w < word; w++) {
+        rank += std::popcount(_words[w]);
+    }
+
+    uint8_t rem = i & 0x3f;
+    if (rem) {
+        rank += std::popcount(_words[word] >> (0x40 - rem));
+    }
+
+    return rank;
+}
+
+uint64_t bitio::rank_select::rank0(uint64_t i) const {
+    return i - rank1(i);
+}
+
+uint64_t bitio::rank_select::select1(uint64_t k) const {
+    if (k >= _ones) {
+        throw bitio_exception("rank_select: select out of range");
+    }
+
+    // The samples narrow the superblock search to the range holding the k-th one.
+    uint64_t sample = k / BITIO_RS_SELECT_SAMPLE;
+    uint64_t lo = _select_samples[sample];
+    uint64_t hi = _select_samples[sample + 1] + 1;
+
+    while (hi - lo > 1) {
+        uint64_t mid = (lo + hi) >> 1;
+        if (_superblocks[mid] <= k) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    k -= _superblocks[lo];
+
+    uint64_t block = lo * (BITIO_RS_SUPERBLOCK_BITS / BITIO_RS_BLOCK_BITS);
+    uint64_t block_end = std::min<uint64_t>(block + BITIO_RS_SUPERBLOCK_BITS / BITIO_RS_BLOCK_BITS, _blocks.size());
+    while (block + 1 < block_end && _blocks[block + 1] <= k) {
+        block++;
+    }
+
+    k -= _blocks[block];
+
+    uint64_t word = block * (BITIO_RS_BLOCK_BITS / 64);
+    for (;; word++) {
+        uint64_t count = std::popcount(_words[word]);
+        if (k < count) {
+            break;
+        }
+        k -= count;
+    }
+
+    return (word << 6) + select_in_word(_words[word], k);
+}
+
+uint64_t bitio::rank_select::select0(uint64_t k) const {
+    if (k >= _size - _ones) {
+        throw bitio_exception("rank_select: select out of range");
+    }
+
+    uint64_t lo = 0;
+    uint64_t hi = _superblocks.size() - 1;
+
+    while (hi - lo > 1) {
+        uint64_t mid = (lo + hi) >> 1;
+        if (zeros_before_superblock(mid) <= k) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    k -= zeros_before_superblock(lo);
+
+    uint64_t block = lo * (BITIO_RS_SUPERBLOCK_BITS / BITIO_RS_BLOCK_BITS);
+    uint64_t block_end = std::min<uint64_t>(block + BITIO_RS_SUPERBLOCK_BITS / BITIO_RS_BLOCK_BITS, _blocks.size());
+    uint64_t first_block = block;
+    while (block + 1 < block_end &&
+           (block + 1 - first_block) * BITIO_RS_BLOCK_BITS - _blocks[block + 1] <= k) {
+        block++;
+    }
+
+    k -= (block - first_block) * BITIO_RS_BLOCK_BITS - _blocks[block];
+
+    uint64_t word = block * (BITIO_RS_BLOCK_BITS / 64);
+    for (;; word++) {
+        uint64_t count = 0x40 - std::popcount(_words[word]);
+        if (k < count) {
+            break;
+        }
+        k -= count;
+    }
+
+    return (word << 6) + select_in_word(~_words[word], k);
+}
+
+bool bitio::rank_select::access(uint64_t i) const {
+    if (i >= _size) {
+        throw bitio_exception("rank_select: position out of range");
+    }
+
+    return (_words[i >> 6] >> (0x3f - (i & 0x3f))) & 1;
+}
+
+uint64_t bitio::rank_select::size() const {
+    return _size;
+}
+
+uint64_t bitio::rank_select::ones() const {
+    return _ones;
+}
+
+void bitio::rank_select::store(stream &s) const {
+    s.write(_size, 0x40);
+    s.write(_ones, 0x40);
+
+    for (auto count : _superblocks) {
+        s.write(count, 0x40);
+    }
+
+    for (auto count : _blocks) {
+        s.write(count, 0x10);
+    }
+}
+
+bitio::rank_select bitio::rank_select::load(stream &s, uint64_t offset) {
+    rank_select rs;
+    rs._size = s.read(0x40);
+    rs._ones = s.read(0x40);
+
+    rs._superblocks.resize((rs._size + BITIO_RS_SUPERBLOCK_BITS - 1) / BITIO_RS_SUPERBLOCK_BITS + 1);
+    rs._blocks.resize((rs._size + BITIO_RS_BLOCK_BITS - 1) / BITIO_RS_BLOCK_BITS);
+
+    for (auto &count : rs._superblocks) {
+        count = s.read(0x40);
+    }
+
+    for (auto &count : rs._blocks) {
+        count = s.read(0x10);
+    }
+
+    rs.read_words(s, offset);
+    rs.build_samples();
+    return rs;
+}
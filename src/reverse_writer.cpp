@@ -0,0 +1,88 @@
+#include <bitio/reverse_writer.h>
+#include <bitio/bits.h>
+
+bitio::reverse_writer::reverse_writer(stream &s, uint64_t end) {
+    if (end & 0x7) {
+        throw bitio_exception("reverse_writer: end must be byte aligned");
+    }
+
+    _stream = &s;
+    _block.resize(BITIO_REVERSE_BLOCK_SIZE);
+    _block_head = _block.size();
+    _end = end >> 3;
+}
+
+void bitio::reverse_writer::flush_block() {
+    uint64_t n = _block.size() - _block_head;
+    if (n > _end) {
+        throw bitio_exception("reverse_writer: out of space");
+    }
+
+    _end -= n;
+    _stream->write_bytes(_end, _block.data() + _block_head, n);
+    _block_head = _block.size();
+}
+
+void bitio::reverse_writer::write(uint64_t value, uint8_t n) {
+    if (_finished) {
+        throw bitio_exception("reverse_writer: already finished");
+    }
+    if (n == 0) {
+        return;
+    }
+    if (n > 0x40) {
+        throw bitio_exception("write() supports upto 64-bits only");
+    }
+
+    value &= low_mask(n);
+    _size += n;
+
+    // The accumulator holds the first _fill bits of the data, the new bits go in front of them.
+    if (_fill + n < 0x40) {
+        _acc |= value << _fill;
+        _fill += n;
+        return;
+    }
+
+    if (_block_head == 0) {
+        flush_block();
+    }
+
+    _block_head -= 8;
+    store_be64(_block.data() + _block_head, _acc | (value << _fill));
+
+    uint8_t spill = _fill + n - 0x40;
+    _acc = spill ? value >> (n - spill) : 0;
+    _fill = spill;
+}
+
+uint64_t bitio::reverse_writer::size() const {
+    return _size;
+}
+
+uint64_t bitio::reverse_writer::finish() {
+    if (_finished) {
+        throw bitio_exception("reverse_writer: already finished");
+    }
+
+    flush_block();
+
+    if (_fill > (_end << 3)) {
+        throw bitio_exception("reverse_writer: out of space");
+    }
+
+    uint64_t start = (_end << 3) - _fill;
+    _stream->seek_to(start);
+    _stream->write(_acc, _fill);
+    _stream->seek_to(start);
+    _finished = true;
+
+    return start;
+}
+
+uint64_t bitio::reverse_writer::finish(uint64_t to) {
+    uint64_t start = finish();
+    move_bits(*_stream, start, to, _size);
+    _stream->seek_to(to);
+    return _size;
+}
@@ -0,0 +1,111 @@
+#include <bitio/bitio.h>
+#include <bitio/bits.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+void bitio::stream::write_run(bool bit, uint64_t length) {
+    uint64_t position = this->position();
+    uint64_t head = std::min<uint64_t>(length, (8 - (position & 0x7)) & 0x7);
+    if (head) {
+        write(bit ? low_mask(head) : 0, head);
+        position += head;
+        length -= head;
+    }
+
+    if (length == 0) {
+        return;
+    }
+
+    uint64_t byte = position >> 3;
+    uint64_t nbytes = length >> 3;
+    while (nbytes) {
+        uint64_t span;
+        uint8_t *page = page_for_write(byte, nbytes, span);
+        std::memset(page, bit ? 0xff : 0, span);
+
+        byte += span;
+        nbytes -= span;
+    }
+
+    seek_to(byte << 3);
+
+    uint8_t tail = length & 0x7;
+    if (tail) {
+        write(bit ? low_mask(tail) : 0, tail);
+    }
+}
+
+uint64_t bitio::stream::read_run(bool bit, uint64_t limit) {
+    uint64_t position = this->position();
+    uint64_t end = data_end();
+    if (position >= end || limit == 0) {
+        return 0;
+    }
+
+    limit = std::min(limit, end - position);
+
+    // Bits are flipped so that the run is always made of zeros, the leading bits of the first byte are masked off.
+    uint8_t fill = bit ? 0xff : 0;
+    uint64_t fill64 = bit ? UINT64_MAX : 0;
+    uint8_t skip = position & 0x7;
+    uint64_t byte = position >> 3;
+    uint64_t last = (position + limit + 7) >> 3;
+    uint64_t run = 0;
+    bool found = false;
+
+    while (!found && byte < last) {
+        uint64_t span;
+        const uint8_t *page = page_for_read(byte, last - byte, span);
+        uint64_t i = 0;
+
+        if (skip) {
+            uint8_t x = (page[0] ^ fill) & (0xff >> skip);
+            if (x) {
+                run = std::countl_zero(x) - skip;
+                found = true;
+            } else {
+                run = 8 - skip;
+                i = 1;
+            }
+        }
+
+        for (; !found && i + 8 <= span; i += 8) {
+            uint64_t x = load_be64(page + i) ^ fill64;
+            if (x) {
+                run += std::countl_zero(x);
+                found = true;
+            } else {
+                run += 0x40;
+            }
+        }
+
+        for (; !found && i < span; i++) {
+            uint8_t x = page[i] ^ fill;
+            if (x) {
+                run += std::countl_zero(x);
+                found = true;
+            } else {
+                run += 8;
+            }
+        }
+
+        byte += span;
+        skip = 0;
+    }
+
+    run = std::min(run, limit);
+    seek_to(position + run);
+    return run;
+}
+
+void bitio::stream::write_unary(uint64_t value) {
+    write_run(false, value);
+    write(1, 1);
+}
+
+uint64_t bitio::stream::read_unary() {
+    uint64_t value = read_run(false);
+    read(1);
+    return value;
+}
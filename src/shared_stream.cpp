@@ -0,0 +1,178 @@
+#include <bitio/shared_stream.h>
+#include <cerrno>
+#include <climits>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+// Lives at the start of the mapping, the data follows at the next cache line.
+struct bitio::shared_stream::header {
+    uint64_t magic;
+    uint64_t capacity;
+    uint64_t watermark;
+    uint32_t epoch;
+    uint32_t waiters;
+};
+
+#define BITIO_SHARED_HEADER_SIZE 0x40
+
+static long futex(uint32_t *address, int op, uint32_t value) {
+    return ::syscall(SYS_futex, address, op, value, nullptr, nullptr, 0);
+}
+
+bitio::shared_stream bitio::shared_stream::create(uint64_t capacity, const std::string &name) {
+    int fd = ::memfd_create(name.c_str(), MFD_CLOEXEC);
+    if (fd < 0) {
+        throw bitio_exception("shared_stream: memfd_create failed");
+    }
+
+    uint64_t size = BITIO_SHARED_HEADER_SIZE + capacity;
+    if (::ftruncate(fd, size) != 0) {
+        ::close(fd);
+        throw bitio_exception("shared_stream: cannot size region");
+    }
+
+    shared_stream s;
+    s.map(fd, size);
+    s._header->magic = BITIO_SHARED_MAGIC;
+    s._header->capacity = capacity;
+    return s;
+}
+
+bitio::shared_stream bitio::shared_stream::open(int fd) {
+    struct stat st{};
+    int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own < 0 || ::fstat(own, &st) != 0 || uint64_t(st.st_size) < BITIO_SHARED_HEADER_SIZE) {
+        if (own >= 0) {
+            ::close(own);
+        }
+        throw bitio_exception("shared_stream: not a shared stream");
+    }
+
+    shared_stream s;
+    s.map(own, st.st_size);
+    if (s._header->magic != BITIO_SHARED_MAGIC || s._header->capacity + BITIO_SHARED_HEADER_SIZE > s._mapping_size) {
+        throw bitio_exception("shared_stream: not a shared stream");
+    }
+    return s;
+}
+
+void bitio::shared_stream::map(int fd, uint64_t size) {
+    void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd);
+        throw bitio_exception("shared_stream: mmap failed");
+    }
+
+    _fd = fd;
+    _mapping = (uint8_t *) p;
+    _mapping_size = size;
+    _header = (header *) p;
+    _stream = bitio::stream(_mapping + BITIO_SHARED_HEADER_SIZE, size - BITIO_SHARED_HEADER_SIZE);
+}
+
+void bitio::shared_stream::release() {
+    _stream = bitio::stream();
+    if (_mapping) {
+        ::munmap(_mapping, _mapping_size);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+
+    _mapping = nullptr;
+    _header = nullptr;
+    _fd = -1;
+}
+
+bitio::shared_stream::shared_stream(shared_stream &&other) noexcept {
+    _fd = std::exchange(other._fd, -1);
+    _mapping = std::exchange(other._mapping, nullptr);
+    _mapping_size = other._mapping_size;
+    _header = std::exchange(other._header, nullptr);
+    _stream = std::move(other._stream);
+}
+
+bitio::shared_stream &bitio::shared_stream::operator=(shared_stream &&other) noexcept {
+    if (this != &other) {
+        release();
+        _fd = std::exchange(other._fd, -1);
+        _mapping = std::exchange(other._mapping, nullptr);
+        _mapping_size = other._mapping_size;
+        _header = std::exchange(other._header, nullptr);
+        _stream = std::move(other._stream);
+    }
+    return *this;
+}
+
+bitio::shared_stream::~shared_stream() {
+    release();
+}
+
+int bitio::shared_stream::fd() const {
+    return _fd;
+}
+
+uint64_t bitio::shared_stream::capacity() const {
+    return _header->capacity;
+}
+
+bitio::stream &bitio::shared_stream::stream() {
+    return _stream;
+}
+
+void bitio::shared_stream::publish() {
+    publish(_stream.position());
+}
+
+void bitio::shared_stream::publish(uint64_t nbits) {
+    if (nbits > _header->capacity * 8) {
+        throw bitio_exception("shared_stream: watermark past capacity");
+    }
+
+    if (nbits <= __atomic_load_n(&_header->watermark, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    __atomic_store_n(&_header->watermark, nbits, __ATOMIC_RELEASE);
+
+    // Waking costs a syscall, so it is skipped while nobody is blocked in wait().
+    __atomic_add_fetch(&_header->epoch, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&_header->waiters, __ATOMIC_SEQ_CST)) {
+        futex(&_header->epoch, FUTEX_WAKE, INT_MAX);
+    }
+}
+
+uint64_t bitio::shared_stream::watermark() const {
+    return __atomic_load_n(&_header->watermark, __ATOMIC_ACQUIRE);
+}
+
+uint64_t bitio::shared_stream::wait(uint64_t nbits) const {
+    uint64_t current = watermark();
+    if (current >= nbits) {
+        return current;
+    }
+
+    __atomic_add_fetch(&_header->waiters, 1, __ATOMIC_SEQ_CST);
+    for (;;) {
+        uint32_t epoch = __atomic_load_n(&_header->epoch, __ATOMIC_SEQ_CST);
+        current = watermark();
+        if (current >= nbits) {
+            break;
+        }
+
+        // Returns right away when a publish() bumped the epoch in between.
+        futex(&_header->epoch, FUTEX_WAIT, epoch);
+    }
+    __atomic_sub_fetch(&_header->waiters, 1, __ATOMIC_SEQ_CST);
+
+    return current;
+}
+
+bitio::bit_view bitio::shared_stream::published() {
+    return {_stream, 0, watermark()};
+}
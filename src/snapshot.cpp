@@ -0,0 +1,199 @@
+#include <bitio/snapshot.h>
+#include <atomic>
+#include <cstring>
+#include <bitio/bits.h>
+
+static uint64_t read_bits(const std::vector<std::shared_ptr<uint8_t[]>> &pages, uint64_t page_size,
+                          uint64_t position, uint8_t n) {
+    uint64_t byte = position >> 3;
+    uint8_t bit = position & 0x7;
+    uint64_t page_index = byte / page_size;
+    uint64_t index = byte % page_size;
+    const uint8_t *page = pages[page_index].get();
+
+    if (bit + n <= 0x40 && index + 8 <= page_size) {
+        return (bitio::load_be64(page + index) << bit) >> (0x40 - n);
+    }
+
+    uint64_t value = 0;
+    while (n) {
+        if (index == page_size) {
+            page = pages[++page_index].get();
+            index = 0;
+        }
+
+        uint8_t take = std::min<uint8_t>(8 - bit, n);
+        value = (value << take) | ((page[index] >> (8 - bit - take)) & bitio::u8_rmasks[take]);
+
+        n -= take;
+        bit = 0;
+        index++;
+    }
+
+    return value;
+}
+
+static void seek_cursor(uint64_t &position, uint64_t size, int64_t n) {
+    if (n < 0 && uint64_t(-n) > position) {
+        throw bitio::bitio_exception("SOF reached");
+    }
+
+    if (n > 0 && uint64_t(n) > size - position) {
+        throw bitio::bitio_exception("EOF encountered");
+    }
+
+    position += n;
+}
+
+uint64_t bitio::snapshot::read(uint8_t n) {
+    if (n == 0) {
+        return 0;
+    }
+
+    if (!_image || n > _image->size - _position) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    uint64_t value = read_bits(_image->pages, _image->page_size, _position, n);
+    _position += n;
+    return value;
+}
+
+void bitio::snapshot::seek(int64_t n) {
+    seek_cursor(_position, size(), n);
+}
+
+void bitio::snapshot::seek_to(uint64_t n) {
+    if (n > size()) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    _position = n;
+}
+
+uint64_t bitio::snapshot::position() const {
+    return _position;
+}
+
+uint64_t bitio::snapshot::size() const {
+    return _image ? _image->size : 0;
+}
+
+bitio::cow_stream::cow_stream(uint64_t page_size, allocator *alloc) {
+    if (page_size < 8) {
+        throw bitio_exception("cow_stream: page size must be at least 8 bytes");
+    }
+
+    _page_size = page_size;
+    _allocator = alloc ? alloc : heap_allocator();
+}
+
+std::shared_ptr<uint8_t[]> bitio::cow_stream::allocate_page(const uint8_t *source) {
+    allocator *alloc = _allocator;
+    uint64_t size = _page_size;
+
+    uint8_t *data = alloc->allocate(size, BITIO_DEFAULT_ALIGNMENT);
+    if (source) {
+        std::memcpy(data, source, size);
+    } else {
+        std::memset(data, 0, size);
+    }
+
+    return {data, [alloc, size](uint8_t *p) { alloc->deallocate(p, size, BITIO_DEFAULT_ALIGNMENT); }};
+}
+
+uint8_t *bitio::cow_stream::writable_byte(uint64_t offset) {
+    uint64_t page = offset / _page_size;
+    if (page == _owned_page) {
+        return _owned + offset % _page_size;
+    }
+
+    if (page >= _pages.size()) {
+        _pages.resize(page + 1);
+    }
+
+    auto &slot = _pages[page];
+    if (!slot) {
+        slot = allocate_page(nullptr);
+    } else if (slot.use_count() > 1) {
+        slot = allocate_page(slot.get());
+    } else {
+        // The last snapshot holding the page may just have been dropped by a reader, its reads have to happen
+        // before the writes below.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    _owned_page = page;
+    _owned = slot.get();
+    return _owned + offset % _page_size;
+}
+
+uint64_t bitio::cow_stream::read(uint8_t n) {
+    if (n == 0) {
+        return 0;
+    }
+
+    if (n > _size - _position) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    uint64_t value = read_bits(_pages, _page_size, _position, n);
+    _position += n;
+    return value;
+}
+
+void bitio::cow_stream::write(uint64_t obj, uint8_t n) {
+    if (n > 0x40) {
+        throw bitio_exception("write() supports upto 64-bits only");
+    }
+
+    while (n) {
+        uint8_t *byte = writable_byte(_position >> 3);
+        uint8_t bit = _position & 0x7;
+        uint8_t take = std::min<uint8_t>(8 - bit, n);
+        uint8_t shift = 8 - bit - take;
+        uint8_t chunk = (obj >> (n - take)) & u8_rmasks[take];
+
+        *byte = (*byte & ~(u8_rmasks[take] << shift)) | (chunk << shift);
+
+        n -= take;
+        _position += take;
+    }
+
+    _size = std::max(_size, _position);
+}
+
+void bitio::cow_stream::seek(int64_t n) {
+    seek_cursor(_position, _size, n);
+}
+
+void bitio::cow_stream::seek_to(uint64_t n) {
+    if (n > _size) {
+        throw bitio_exception("EOF encountered");
+    }
+
+    _position = n;
+}
+
+uint64_t bitio::cow_stream::position() const {
+    return _position;
+}
+
+uint64_t bitio::cow_stream::size() const {
+    return _size;
+}
+
+bitio::snapshot bitio::cow_stream::snapshot() {
+    auto image = std::make_shared<bitio::snapshot::image>();
+    image->pages.assign(_pages.begin(), _pages.begin() + (_size + _page_size * 8 - 1) / (_page_size * 8));
+    image->page_size = _page_size;
+    image->size = _size;
+
+    // Every shared page has to be copied before it is written again.
+    _owned_page = UINT64_MAX;
+    _owned = nullptr;
+
+    bitio::snapshot s;
+    s._image = std::move(image);
+    return s;
+}
@@ -0,0 +1,149 @@
+#include <bitio/streambuf.h>
+#include <algorithm>
+#include <cstring>
+
+bitio::streambuf::streambuf(stream &s) {
+    if (s.position() & 0x7) {
+        throw bitio_exception("streambuf: the stream cursor must be byte aligned");
+    }
+
+    _stream = &s;
+    _begin = s.position() >> 3;
+    _put.resize(BITIO_STREAMBUF_PUT_SIZE);
+}
+
+bitio::streambuf::~streambuf() {
+    settle();
+    _stream->seek_to((_begin + _offset) << 3);
+}
+
+// Writes at the current offset page by page and returns how many bytes made it before the stream failed.
+uint64_t bitio::streambuf::put(const char *s, uint64_t n) {
+    uint64_t done = 0;
+    try {
+        while (done < n) {
+            uint64_t span;
+            uint8_t *page = _stream->page_for_write(_begin + _offset + done, n - done, span);
+            std::memcpy(page, s + done, span);
+            done += span;
+        }
+    } catch (bitio_exception &) {}
+
+    _offset += done;
+    return done;
+}
+
+uint64_t bitio::streambuf::current() const {
+    if (eback()) {
+        return _offset + (gptr() - eback());
+    }
+
+    if (pbase()) {
+        return _offset + (pptr() - pbase());
+    }
+
+    return _offset;
+}
+
+// Ends the get or put area in use: pending writes go to the stream, and a get area must not outlive a page load.
+// Returns false when not all pending bytes could be written, the offset then stops after the last one that was.
+bool bitio::streambuf::settle() {
+    bool ok = true;
+    if (pbase()) {
+        uint64_t n = pptr() - pbase();
+        ok = put(pbase(), n) == n;
+    } else {
+        _offset = current();
+    }
+
+    setg(nullptr, nullptr, nullptr);
+    setp(nullptr, nullptr);
+    return ok;
+}
+
+bitio::streambuf::int_type bitio::streambuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    settle();
+
+    // Streaming input only finds its end by reading on.
+    uint64_t end = _stream->_streaming ? UINT64_MAX : _stream->data_end() >> 3;
+    if (_begin + _offset >= end) {
+        return traits_type::eof();
+    }
+
+    uint64_t span;
+    char *page;
+    try {
+        page = (char *) _stream->page_for_read(_begin + _offset, end - _begin - _offset, span);
+    } catch (bitio_exception &) {
+        return traits_type::eof();
+    }
+
+    setg(page, page, page + span);
+    return traits_type::to_int_type(*gptr());
+}
+
+bitio::streambuf::int_type bitio::streambuf::overflow(int_type c) {
+    if (!settle()) {
+        return traits_type::eof();
+    }
+
+    setp(_put.data(), _put.data() + _put.size());
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize bitio::streambuf::xsputn(const char *s, std::streamsize n) {
+    if (n < std::streamsize(_put.size())) {
+        return std::streambuf::xsputn(s, n);
+    }
+
+    if (!settle()) {
+        return 0;
+    }
+    return put(s, n);
+}
+
+std::streamsize bitio::streambuf::showmanyc() {
+    uint64_t end = _stream->data_end() >> 3;
+    uint64_t position = _begin + current();
+    return position < end ? std::streamsize(end - position) : -1;
+}
+
+bitio::streambuf::pos_type bitio::streambuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                     std::ios_base::openmode) {
+    if (!settle()) {
+        return pos_type(off_type(-1));
+    }
+
+    int64_t base = 0;
+    if (dir == std::ios_base::cur) {
+        base = _offset;
+    } else if (dir == std::ios_base::end) {
+        base = (_stream->data_end() >> 3) - _begin;
+    }
+
+    if (base + off < 0) {
+        return pos_type(off_type(-1));
+    }
+
+    _offset = base + off;
+    return pos_type(off_type(_offset));
+}
+
+bitio::streambuf::pos_type bitio::streambuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+int bitio::streambuf::sync() {
+    bool ok = settle();
+    _stream->seek_to((_begin + _offset) << 3);
+    return ok ? 0 : -1;
+}
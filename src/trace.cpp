@@ -0,0 +1,103 @@
+#include <bitio/trace.h>
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+
+bitio::trace_recorder::trace_recorder(const std::string &filename) {
+    std::remove(filename.c_str());
+    _stream = bitio::stream(filename);
+}
+
+bitio::trace_recorder::~trace_recorder() {
+    close();
+}
+
+void bitio::trace_recorder::write_value(uint64_t value) {
+    uint8_t width = std::bit_width(value);
+    _stream.write(width, 7);
+    _stream.write(value, width);
+}
+
+void bitio::trace_recorder::record(trace_op op, uint64_t value) {
+    if (_closed) {
+        return;
+    }
+
+    _stream.write(uint8_t(op), 3);
+    _events++;
+
+    switch (op) {
+        case trace_op::read:
+        case trace_op::write:
+            _stream.write(value - 1, 6);
+            break;
+        case trace_op::seek: {
+            // Zigzag, so short backward seeks stay short.
+            auto n = int64_t(value);
+            write_value((uint64_t(n) << 1) ^ uint64_t(n >> 63));
+            break;
+        }
+        case trace_op::seek_to:
+        case trace_op::begin:
+            write_value(value);
+            break;
+        default:
+            break;
+    }
+}
+
+uint64_t bitio::trace_recorder::events() const {
+    return _events;
+}
+
+void bitio::trace_recorder::close() {
+    if (_closed) {
+        return;
+    }
+
+    _stream.write(uint8_t(trace_op::end), 3);
+    _stream.flush();
+    _closed = true;
+}
+
+bitio::trace_reader::trace_reader(const std::string &filename) {
+    if (!std::filesystem::exists(filename)) {
+        throw bitio_exception("trace file not found");
+    }
+
+    _stream = bitio::stream(filename);
+}
+
+bool bitio::trace_reader::next(trace_event &event) {
+    if (_done) {
+        return false;
+    }
+
+    event.op = trace_op(_stream.read(3));
+    event.value = 0;
+
+    switch (event.op) {
+        case trace_op::read:
+        case trace_op::write:
+            event.value = _stream.read(6) + 1;
+            break;
+        case trace_op::seek: {
+            uint64_t zigzag = _stream.read(_stream.read(7));
+            event.value = (zigzag >> 1) ^ -(zigzag & 1);
+            break;
+        }
+        case trace_op::seek_to:
+        case trace_op::begin:
+            event.value = _stream.read(_stream.read(7));
+            break;
+        case trace_op::flush:
+            break;
+        case trace_op::end:
+            _done = true;
+            return false;
+        default:
+            throw bitio_exception("corrupt trace");
+    }
+
+    return true;
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <bitio/bit_reader.h>
+#include <bitio/bits.h>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+static_assert(std::is_trivially_copyable_v<bitio::bit_reader>);
+
+TEST(BitReaderTest, bit_reader_1) {
+    static const uint8_t data[] = {0xde, 0xad, 0xbe, 0xef, 0x01};
+    bitio::bit_reader reader(data, sizeof(data));
+
+    ASSERT_EQ(reader.size(), 40);
+    ASSERT_EQ(reader.read(4), 0xd);
+    ASSERT_EQ(reader.peek(12), 0xead);
+    ASSERT_EQ(reader.read(12), 0xead);
+
+    // Copies are independent cursors.
+    auto fork = reader;
+    ASSERT_EQ(fork.read(16), 0xbeef);
+    ASSERT_EQ(reader.position(), 16);
+    ASSERT_EQ(reader.read(24), 0xbeef01);
+    ASSERT_TRUE(reader.eof());
+
+    ASSERT_THROW(reader.read(1), bitio::bitio_exception);
+    ASSERT_FALSE(fork.try_read(9).has_value());
+    ASSERT_EQ(fork.position(), 32);
+    ASSERT_EQ(fork.try_read(8), 0x01);
+
+    fork.seek(-40);
+    ASSERT_EQ(fork.read(0x40 - 24), 0xdeadbeef01);
+    ASSERT_THROW(fork.seek(1), bitio::bitio_exception);
+    ASSERT_THROW(fork.seek(-41), bitio::bitio_exception);
+}
+
+TEST(BitReaderTest, bit_reader_2) {
+    std::vector<uint8_t> raw(0x1000 + 3);
+    auto stream = bitio::stream(raw.data(), raw.size());
+
+    std::mt19937_64 rng(48);
+    std::vector<std::pair<uint64_t, uint8_t>> values;
+    while (true) {
+        uint8_t n = rng() % 64 + 1;
+        if (stream.position() + n > raw.size() * 8) {
+            break;
+        }
+        uint64_t value = rng() & bitio::low_mask(n);
+        stream.write(value, n);
+        values.emplace_back(value, n);
+    }
+
+    const std::vector<uint8_t> &shared = raw;
+    bitio::bit_reader reader(std::as_bytes(std::span(shared)));
+    auto check = [&](bitio::bit_reader r) {
+        for (auto [value, n] : values) {
+            ASSERT_EQ(r.read(n), value);
+        }
+    };
+
+    std::thread a(check, reader), b(check, reader);
+    a.join();
+    b.join();
+    check(reader);
+    ASSERT_EQ(reader.position(), 0);
+}
+
+TEST(BitReaderTest, run_1) {
+    std::vector<uint8_t> raw(0x100);
+    auto stream = bitio::stream(raw.data(), raw.size());
+    stream.write(0x3, 2);
+    stream.write_run(true, 200);
+    stream.write_unary(70);
+    stream.write_unary(0);
+
+    bitio::bit_reader reader(raw.data(), raw.size());
+    ASSERT_EQ(reader.read_run(false), 0);
+    ASSERT_EQ(reader.read_run(true), 202);
+    ASSERT_EQ(reader.read_unary(), 70);
+    ASSERT_EQ(reader.read_unary(), 0);
+    ASSERT_EQ(reader.read_run(false, 10), 10);
+    ASSERT_EQ(reader.read_run(false), reader.size() - reader.position());
+    ASSERT_TRUE(reader.eof());
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <bitio/bit_view.h>
+
+TEST(BitViewTest, bit_view_1) {
+    uint8_t raw[64]{};
+    auto stream = bitio::stream(raw, 64);
+    for (int i = 0; i < 40; i++) {
+        stream.write(i, 12);
+    }
+
+    // Records 10..19 as a view, then records 13..15 as a view of that.
+    bitio::bit_view view(stream, 12 * 10, 12 * 10);
+    ASSERT_EQ(view.read(12), 10);
+    ASSERT_EQ(view.remaining(), 12 * 9);
+
+    auto inner = view.view(12 * 3, 12 * 3);
+    ASSERT_EQ(inner.offset(), 12 * 13);
+    for (int i = 13; i < 16; i++) {
+        ASSERT_EQ(inner.read(12), i);
+    }
+    ASSERT_TRUE(inner.eof());
+    ASSERT_THROW(inner.read(1), bitio::bitio_exception);
+
+    // The outer cursor is independent of the inner one and of the parent.
+    ASSERT_EQ(view.read(12), 11);
+
+    view.seek_to(12 * 9);
+    ASSERT_EQ(view.read(12), 19);
+    ASSERT_THROW(view.read(12), bitio::bitio_exception);
+    ASSERT_THROW((void) view.view(12 * 5, 12 * 6), bitio::bitio_exception);
+
+    view.seek(-12 * 10);
+    ASSERT_THROW(view.seek(-1), bitio::bitio_exception);
+
+    // Writes are bounded as well and land in the parent's pages.
+    inner.seek_to(0);
+    inner.write(0xabc, 12);
+    ASSERT_THROW(inner.write(0, 25), bitio::bitio_exception);
+
+    stream.seek_to(12 * 13);
+    ASSERT_EQ(stream.read(12), 0xabc);
+    ASSERT_EQ(stream.read(12), 14);
+}
+
+TEST(BitViewTest, bit_view_file) {
+    remove("bitio_test.dat");
+    auto stream = bitio::stream("bitio_test.dat", 7);
+    for (int i = 0; i < 1000; i++) {
+        stream.write(i, 17);
+    }
+
+    bitio::bit_view view(stream, 17 * 500, 17 * 100);
+    for (int i = 500; i < 600; i++) {
+        ASSERT_EQ(view.read(17), i);
+    }
+    ASSERT_TRUE(view.eof());
+
+    remove("bitio_test.dat");
+}
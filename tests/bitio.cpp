@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <bitio/bitio.h>
+#include <cerrno>
 #include <chrono>
+#include <unistd.h>
+#include <sys/stat.h>
 
 class BitioTest : testing::Test {
 };
@@ -838,4 +841,260 @@ TEST(BitioTest, raw_buffer_1) {
     ASSERT_EQ(stream.read(0x8), 129);
 
     delete[] raw;
-}
\ No newline at end of file
+}
+TEST(BitioTest, direct_io_1) {
+    remove("bitio_test.dat");
+
+    auto stream = new bitio::stream("bitio_test.dat", 5000, BITIO_DIRECT_IO);
+
+    for (int i = 0; i < 10001; i++) {
+        stream->write(i, 0x18);
+    }
+    stream->write(0x5, 0x3);
+    stream->flush();
+
+    ASSERT_EQ(stream->size(), 30004);
+
+    stream->seek_to(24 * 5000);
+    ASSERT_EQ(stream->read(0x18), 5000);
+
+    delete stream;
+
+    stream = new bitio::stream("bitio_test.dat", 3);
+
+    ASSERT_EQ(stream->size(), 30004);
+
+    for (int i = 0; i < 10001; i++) {
+        ASSERT_EQ(stream->read(0x18), i);
+    }
+    ASSERT_EQ(stream->read(0x3), 0x5);
+
+    delete stream;
+}
+
+TEST(BitioTest, allocator_1) {
+    remove("bitio_test.dat");
+
+    bitio::pool_allocator pool;
+
+    {
+        auto stream = bitio::stream("bitio_test.dat", 64, 0, &pool);
+        stream.write(0xabcd, 16);
+    }
+
+    uint8_t *cached = pool.allocate(64, BITIO_DEFAULT_ALIGNMENT);
+    pool.deallocate(cached, 64, BITIO_DEFAULT_ALIGNMENT);
+
+    {
+        auto stream = bitio::stream("bitio_test.dat", 64, 0, &pool);
+        ASSERT_EQ(stream.read(16), 0xabcd);
+    }
+
+    // The buffer released by the last stream is handed out again.
+    ASSERT_EQ(pool.allocate(64, BITIO_DEFAULT_ALIGNMENT), cached);
+    pool.deallocate(cached, 64, BITIO_DEFAULT_ALIGNMENT);
+
+    auto stream = bitio::stream("bitio_test.dat", 0x1000, 0, bitio::hugepage_allocator());
+    ASSERT_EQ(stream.read(16), 0xabcd);
+}
+
+TEST(BitioTest, move_1) {
+    remove("bitio_test.dat");
+
+    auto stream = bitio::stream("bitio_test.dat", 2);
+    stream.write(0x1234, 16);
+    stream.write(0x56, 8);
+
+    auto moved = std::move(stream);
+    moved.write(0x78, 8);
+
+    bitio::stream assigned;
+    assigned = std::move(moved);
+    assigned.seek_to(0);
+
+    ASSERT_EQ(assigned.read(32), 0x12345678);
+}
+
+TEST(BitioTest, streaming_1) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    FILE *in = fdopen(fds[0], "rb");
+    FILE *out = fdopen(fds[1], "wb");
+
+    auto writer = new bitio::stream(out, 4, BITIO_STREAMING_OUT);
+
+    for (int i = 0; i < 1000; i++) {
+        writer->write(i, 20);
+    }
+
+    // Finished pages are already in the pipe before the writer is flushed.
+    uint8_t head[5];
+    ASSERT_EQ(read(fds[0], head, 5), 5);
+    ASSERT_EQ(head[2], 0x0);
+    ASSERT_EQ(head[4], 0x1);
+
+    writer->seek(-20);
+    ASSERT_EQ(writer->read(20), 999);
+    writer->seek(-20 * 500);
+    ASSERT_THROW(writer->read(20), bitio::bitio_exception);
+
+    delete writer;
+
+    auto reader = new bitio::stream(in, 3, BITIO_STREAMING_IN);
+
+    for (int i = 2; i < 1000; i++) {
+        ASSERT_EQ(reader->read(20), i);
+    }
+
+    reader->seek(-40);
+    ASSERT_EQ(reader->read(20), 998);
+    ASSERT_THROW(reader->write(1, 1), bitio::bitio_exception);
+
+    reader->seek(-8 * 100);
+    ASSERT_THROW(reader->read(8), bitio::bitio_exception);
+
+    reader->seek_to(20 * 998 - 4);
+    ASSERT_EQ(reader->read(4), 7);
+    ASSERT_THROW(reader->read(8), bitio::bitio_exception);
+
+    delete reader;
+}
+
+TEST(BitioTest, try_read_1) {
+    uint8_t raw[2] = {0xab, 0xcd};
+    auto stream = bitio::stream(raw, 2);
+
+    ASSERT_EQ(stream.try_read(12), 0xabc);
+    ASSERT_FALSE(stream.try_read(5).has_value());
+    ASSERT_EQ(stream.position(), 12);
+    ASSERT_EQ(stream.try_read(4), 0xd);
+    ASSERT_FALSE(stream.try_read(1).has_value());
+
+    // Reading past the end of an in-memory buffer throws instead of wrapping around.
+    ASSERT_THROW(stream.read(8), bitio::bitio_exception);
+}
+
+TEST(BitioTest, try_read_2) {
+    std::remove("try_read_test_2.dat");
+    auto stream = bitio::stream("try_read_test_2.dat", 4);
+    for (int i = 0; i < 11; i++) {
+        stream.write(i, 8);
+    }
+
+    // The last page is only cached, not on disk yet.
+    stream.seek_to(0);
+    for (int i = 0; i < 11; i++) {
+        ASSERT_EQ(stream.try_read(8), i);
+    }
+    ASSERT_FALSE(stream.try_read(1).has_value());
+
+    stream.seek_to(8 * 3 + 4);
+    ASSERT_EQ(stream.try_read(16), 0x3040);
+    ASSERT_FALSE(stream.try_read(64).has_value());
+    ASSERT_EQ(stream.position(), 8 * 5 + 4);
+    std::remove("try_read_test_2.dat");
+}
+
+TEST(BitioTest, padded_1) {
+    std::remove("padded_test_1.dat");
+    {
+        auto stream = bitio::stream("padded_test_1.dat", 16);
+        for (int i = 0; i < 40; i++) {
+            stream.write(i, 7);
+        }
+        stream.write(0x7, 3);
+    }
+
+    auto stream = bitio::stream("padded_test_1.dat", 16, BITIO_PADDED);
+    for (int i = 0; i < 40; i++) {
+        ASSERT_EQ(stream.read(7), i);
+    }
+    ASSERT_FALSE(stream.overrun());
+
+    // The data ends with the last byte, whatever follows reads as zeros.
+    ASSERT_EQ(stream.read(8), 0xe0);
+    ASSERT_FALSE(stream.overrun());
+    ASSERT_EQ(stream.read(8), 0);
+    ASSERT_TRUE(stream.overrun());
+    ASSERT_EQ(stream.read(64), 0);
+    ASSERT_EQ(stream.read(64), 0);
+    std::remove("padded_test_1.dat");
+}
+
+TEST(BitioTest, padded_2) {
+    std::remove("padded_test_2.dat");
+    auto stream = bitio::stream("padded_test_2.dat", 32, BITIO_PADDED);
+    for (int i = 0; i < 100; i++) {
+        stream.write(i * 0x9e3779b97f4a7c15ull, 61);
+    }
+
+    stream.seek_to(0);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(stream.read(61), (i * 0x9e3779b97f4a7c15ull) & ((1ull << 61) - 1));
+    }
+    ASSERT_FALSE(stream.overrun());
+    std::remove("padded_test_2.dat");
+}
+
+TEST(BitioTest, sparse_1) {
+    std::remove("sparse_test_1.dat");
+    {
+        auto stream = bitio::stream("sparse_test_1.dat", 0x10000);
+        ASSERT_TRUE(stream.preallocate(0x100000) || errno == EOPNOTSUPP);
+        stream.write(0xab, 8);
+
+        // Far past the end of the file: the gap is never written.
+        stream.seek_to(0x4000000ull * 8 + 0x8000 * 8);
+        stream.write(0xcd, 8);
+        stream.flush();
+        ASSERT_EQ(stream.size(), 0x4008001);
+        ASSERT_LT(stream.stats().bytes_committed, 0x20000);
+
+        stream.seek_to(0x4000000ull * 8);
+        ASSERT_EQ(stream.read(8), 0);
+        stream.seek_to(0x4000000ull * 8 + 0x8000 * 8);
+        ASSERT_EQ(stream.read(8), 0xcd);
+    }
+
+    struct stat st{};
+    ASSERT_EQ(stat("sparse_test_1.dat", &st), 0);
+    ASSERT_EQ(st.st_size, 0x4008001);
+    ASSERT_LT(st.st_blocks * 512, 0x400000);
+    std::remove("sparse_test_1.dat");
+}
+
+TEST(BitioTest, truncate_1) {
+    std::remove("truncate_test_1.dat");
+    auto stream = bitio::stream("truncate_test_1.dat", 0x40);
+    for (int i = 0; i < 100; i++) {
+        stream.write(0xffffffff, 32);
+    }
+    stream.flush();
+    ASSERT_EQ(stream.size(), 400);
+
+    stream.truncate(1001);
+    ASSERT_EQ(stream.size(), 126);
+    stream.flush();
+
+    struct stat st{};
+    ASSERT_EQ(stat("truncate_test_1.dat", &st), 0);
+    ASSERT_EQ(st.st_size, 126);
+
+    stream.seek_to(992);
+    ASSERT_EQ(stream.read(9), 0x1ff);
+    ASSERT_EQ(stream.read(7), 0);
+    ASSERT_THROW(stream.read(8), bitio::bitio_exception);
+
+    // Writes past the end extend it again.
+    stream.truncate(64);
+    stream.seek_to(64);
+    stream.write(0x12, 8);
+    stream.flush();
+    ASSERT_EQ(stat("truncate_test_1.dat", &st), 0);
+    ASSERT_EQ(st.st_size, 9);
+
+    stream.seek_to(56);
+    ASSERT_EQ(stream.read(16), 0xff12);
+    std::remove("truncate_test_1.dat");
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <bitio/bitplane.h>
+#include <random>
+#include <vector>
+
+// Bit-by-bit reference of the bit-plane layout.
+static void write_naive(bitio::stream &s, const std::vector<uint64_t> &values, uint8_t width, uint16_t block) {
+    for (uint64_t b = 0; b < values.size(); b += block) {
+        uint64_t n = std::min<uint64_t>(block, values.size() - b);
+        for (uint8_t k = width; k-- > 0;) {
+            for (uint64_t i = 0; i < n; i++) {
+                s.write((values[b + i] >> k) & 1, 1);
+            }
+        }
+    }
+}
+
+TEST(BitplaneTest, layout_1) {
+    std::mt19937_64 rng(46);
+
+    for (uint16_t block : {0x40, 0x80, 0x100}) {
+        for (uint8_t width : {1, 3, 8, 9, 17, 33, 64}) {
+            for (uint64_t count : {1, 63, 64, 65, 300, 5000}) {
+                SCOPED_TRACE(std::to_string(block) + " " + std::to_string(width) + " " + std::to_string(count));
+
+                std::vector<uint64_t> values(count);
+                for (auto &v : values) {
+                    v = width == 64 ? rng() : rng() & ((1ull << width) - 1);
+                }
+
+                uint64_t size = (count * width + 5 + 7) / 8 + 1;
+                std::vector<uint8_t> expected(size), actual(size);
+                auto reference = bitio::stream(expected.data(), size);
+                auto stream = bitio::stream(actual.data(), size);
+
+                reference.write(0x15, 5);
+                write_naive(reference, values, width, block);
+                reference.flush();
+
+                stream.write(0x15, 5);
+                bitio::write_bitplanes(stream, values.data(), count, width, block);
+                ASSERT_EQ(stream.position(), 5 + count * width);
+                stream.flush();
+                ASSERT_EQ(actual, expected);
+
+                std::vector<uint64_t> decoded(count);
+                stream.seek_to(5);
+                bitio::read_bitplanes(stream, decoded.data(), count, width, block);
+                ASSERT_EQ(stream.position(), 5 + count * width);
+                ASSERT_EQ(decoded, values);
+            }
+        }
+    }
+}
+
+TEST(BitplaneTest, errors_1) {
+    uint8_t raw[16]{};
+    auto stream = bitio::stream(raw, 16);
+    uint64_t values[4]{};
+
+    ASSERT_THROW(bitio::write_bitplanes(stream, values, 4, 0), bitio::bitio_exception);
+    ASSERT_THROW(bitio::write_bitplanes(stream, values, 4, 65), bitio::bitio_exception);
+    ASSERT_THROW(bitio::write_bitplanes(stream, values, 4, 8, 100), bitio::bitio_exception);
+    ASSERT_THROW(bitio::read_bitplanes(stream, values, 4, 8, 512), bitio::bitio_exception);
+}
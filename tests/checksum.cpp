@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <bitio/bitio.h>
+#include <bitio/checksum.h>
+#include <random>
+#include <vector>
+
+static uint32_t reference_range(const std::vector<uint8_t> &data, uint64_t offset, uint64_t nbits) {
+    std::vector<uint8_t> packed((nbits + 7) / 8);
+    for (uint64_t i = 0; i < nbits; i++) {
+        uint64_t j = offset + i;
+        if ((data[j >> 3] >> (7 - (j & 7))) & 1) {
+            packed[i >> 3] |= 0x80 >> (i & 7);
+        }
+    }
+    return bitio::crc32c(0, packed.data(), packed.size());
+}
+
+TEST(ChecksumTest, crc32c_1) {
+    const char *check = "123456789";
+    ASSERT_EQ(bitio::crc32c(0, (const uint8_t *) check, 9), 0xe3069283);
+
+    uint32_t a = bitio::crc32c(0, (const uint8_t *) check, 4);
+    uint32_t b = bitio::crc32c(0, (const uint8_t *) check + 4, 5);
+    ASSERT_EQ(bitio::crc32c(a, (const uint8_t *) check + 4, 5), 0xe3069283);
+    ASSERT_EQ(bitio::crc32c_combine(a, b, 5), 0xe3069283);
+}
+
+TEST(ChecksumTest, stream_checksum_1) {
+    remove("bitio_test.dat");
+
+    std::mt19937_64 rng(3);
+    std::vector<uint8_t> data(10000);
+    for (auto &b : data) {
+        b = rng();
+    }
+
+    auto stream = new bitio::stream("bitio_test.dat", 100, BITIO_CHECKSUM);
+    for (auto b : data) {
+        stream->write(b, 8);
+    }
+
+    ASSERT_EQ(stream->checksum(), bitio::crc32c(0, data.data(), data.size()));
+
+    for (int i = 0; i < 50; i++) {
+        uint64_t offset = rng() % 40000;
+        uint64_t nbits = rng() % 40000;
+        ASSERT_EQ(stream->checksum(offset, nbits), reference_range(data, offset, nbits));
+    }
+
+    delete stream;
+
+    auto raw = bitio::stream(data.data(), data.size());
+    ASSERT_EQ(raw.checksum(), bitio::crc32c(0, data.data(), data.size()));
+    ASSERT_EQ(raw.checksum(13, 999), reference_range(data, 13, 999));
+}
+
+TEST(ChecksumTest, stream_checksum_2) {
+    remove("bitio_test.dat");
+
+    std::vector<uint8_t> data(250);
+    for (uint64_t i = 0; i < data.size(); i++) {
+        data[i] = i * 7;
+    }
+
+    auto stream = new bitio::stream("bitio_test.dat", 100, BITIO_CHECKSUM);
+    for (auto b : data) {
+        stream->write(b, 8);
+    }
+
+    // The dirty tail page is hashed where it is, without being written back.
+    ASSERT_EQ(stream->checksum(), bitio::crc32c(0, data.data(), data.size()));
+    ASSERT_EQ(stream->stats().page_commits, 2);
+
+    // A rewritten page does not reuse the checksum recorded when it was loaded.
+    stream->seek_to(8 * 10);
+    stream->write(0x55, 8);
+    data[10] = 0x55;
+    ASSERT_EQ(stream->checksum(), bitio::crc32c(0, data.data(), data.size()));
+    ASSERT_EQ(stream->page_checksums()[0], bitio::crc32c(0, data.data(), 100));
+
+    delete stream;
+}
+
+TEST(ChecksumTest, verify_checksums_1) {
+    remove("bitio_test.dat");
+
+    auto stream = new bitio::stream("bitio_test.dat", 64, BITIO_CHECKSUM);
+    for (int i = 0; i < 1000; i++) {
+        stream->write(i, 16);
+    }
+
+    auto checksums = stream->page_checksums();
+    ASSERT_EQ(checksums.size(), 32);
+    delete stream;
+
+    // Corrupt a byte in the fourth page.
+    FILE *file = fopen("bitio_test.dat", "rb+");
+    fseek(file, 200, SEEK_SET);
+    fputc(0xaa, file);
+    fclose(file);
+
+    stream = new bitio::stream("bitio_test.dat", 64, BITIO_CHECKSUM);
+    stream->verify_checksums(checksums);
+
+    for (int i = 0; i < 96; i++) {
+        ASSERT_EQ(stream->read(16), i);
+    }
+    ASSERT_THROW(stream->read(16), bitio::bitio_exception);
+
+    delete stream;
+}
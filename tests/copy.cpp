@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <bitio/bitio.h>
+#include <random>
+#include <vector>
+
+static bool get_bit(const std::vector<uint8_t> &v, uint64_t i) {
+    return (v[i >> 3] >> (7 - (i & 7))) & 1;
+}
+
+static void set_bit(std::vector<uint8_t> &v, uint64_t i, bool bit) {
+    v[i >> 3] = (v[i >> 3] & ~(0x80 >> (i & 7))) | (bit << (7 - (i & 7)));
+}
+
+TEST(CopyTest, copy_bits_raw) {
+    std::mt19937_64 rng(7);
+    std::vector<uint8_t> src(4096), dst(4096);
+    for (auto &b : src) {
+        b = rng();
+    }
+
+    for (int iter = 0; iter < 200; iter++) {
+        auto expected = dst;
+        uint64_t src_offset = rng() % 8000;
+        uint64_t dst_offset = rng() % 8000;
+        uint64_t nbits = rng() % 20000;
+
+        for (uint64_t i = 0; i < nbits; i++) {
+            set_bit(expected, dst_offset + i, get_bit(src, src_offset + i));
+        }
+
+        bitio::stream s(src.data(), src.size());
+        bitio::stream d(dst.data(), dst.size());
+        bitio::copy_bits(s, src_offset, d, dst_offset, nbits);
+
+        ASSERT_EQ(dst, expected);
+    }
+}
+
+TEST(CopyTest, copy_bits_file) {
+    remove("bitio_test.dat");
+
+    std::vector<uint8_t> raw(1000);
+    for (int i = 0; i < 1000; i++) {
+        raw[i] = i * 7;
+    }
+
+    FILE *file = fopen("bitio_test.dat", "w+");
+    auto stream = new bitio::stream(file, 7);
+    auto source = bitio::stream(raw.data(), raw.size());
+
+    bitio::copy_bits(source, 3, *stream, 5, 7000);
+    stream->flush();
+
+    stream->seek_to(5);
+    source.seek_to(3);
+    for (int i = 0; i < 7000 / 50; i++) {
+        ASSERT_EQ(stream->read(50), source.read(50));
+    }
+
+    delete stream;
+}
+
+TEST(CopyTest, move_bits_overlap) {
+    std::mt19937_64 rng(11);
+    std::vector<uint8_t> buf(1 << 17);
+
+    for (int iter = 0; iter < 20; iter++) {
+        for (auto &b : buf) {
+            b = rng();
+        }
+
+        auto expected = buf;
+        uint64_t from = rng() % 100000;
+        uint64_t to = rng() % 100000;
+        uint64_t nbits = rng() % 900000;
+
+        for (uint64_t i = 0; i < nbits; i++) {
+            set_bit(expected, to + i, get_bit(buf, from + i));
+        }
+
+        bitio::stream s(buf.data(), buf.size());
+        bitio::move_bits(s, from, to, nbits);
+
+        ASSERT_EQ(buf, expected);
+    }
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <bitio/cpu.h>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Every level available on this machine must agree with the scalar kernels.
+TEST(CpuTest, kernels_1) {
+    std::mt19937_64 rng(11);
+    std::vector<uint8_t> data(0x1000 + 1);
+    for (auto &b : data) {
+        b = rng();
+    }
+
+    std::vector<uint64_t> words(333);
+    for (auto &w : words) {
+        w = rng();
+    }
+
+    auto &reference = bitio::kernels(bitio::cpu_level::scalar);
+    for (uint8_t l = 0; l <= uint8_t(bitio::detected_cpu_level()); l++) {
+        auto &k = bitio::kernels(bitio::cpu_level(l));
+        SCOPED_TRACE(bitio::cpu_level_name(bitio::cpu_level(l)));
+
+        ASSERT_EQ(k.crc32c(0, data.data(), data.size()), reference.crc32c(0, data.data(), data.size()));
+        ASSERT_EQ(k.popcount(words.data(), words.size()), reference.popcount(words.data(), words.size()));
+
+        for (int i = 0; i < 100; i++) {
+            uint64_t value = rng();
+            uint64_t mask = rng() & rng();
+            ASSERT_EQ(k.extract_mask(value, mask), reference.extract_mask(value, mask));
+            ASSERT_EQ(k.deposit_mask(value, mask), reference.deposit_mask(value, mask));
+        }
+
+        uint32_t x[64], y[64], z[64];
+        uint64_t codes[64], expected[64];
+        for (int i = 0; i < 64; i++) {
+            x[i] = rng();
+            y[i] = rng();
+            z[i] = rng();
+        }
+        k.morton2_encode(x, y, codes, 64);
+        reference.morton2_encode(x, y, expected, 64);
+        ASSERT_EQ(std::memcmp(codes, expected, sizeof(codes)), 0);
+        k.morton3_encode(x, y, z, codes, 64);
+        reference.morton3_encode(x, y, z, expected, 64);
+        ASSERT_EQ(std::memcmp(codes, expected, sizeof(codes)), 0);
+
+        uint32_t dx[64], dy[64], dz[64], ex[64], ey[64], ez[64];
+        for (auto &code : codes) {
+            code = rng();
+        }
+        k.morton2_decode(codes, dx, dy, 64);
+        reference.morton2_decode(codes, ex, ey, 64);
+        ASSERT_EQ(std::memcmp(dx, ex, sizeof(dx)), 0);
+        ASSERT_EQ(std::memcmp(dy, ey, sizeof(dy)), 0);
+        k.morton3_decode(codes, dx, dy, dz, 64);
+        reference.morton3_decode(codes, ex, ey, ez, 64);
+        ASSERT_EQ(std::memcmp(dx, ex, sizeof(dx)), 0);
+        ASSERT_EQ(std::memcmp(dy, ey, sizeof(dy)), 0);
+        ASSERT_EQ(std::memcmp(dz, ez, sizeof(dz)), 0);
+
+        uint64_t rows[64];
+        std::memcpy(rows, words.data(), sizeof(rows));
+        k.transpose64(rows);
+        for (int i = 0; i < 64; i++) {
+            for (int j = 0; j < 64; j++) {
+                ASSERT_EQ((rows[i] >> (63 - j)) & 1, (words[j] >> (63 - i)) & 1);
+            }
+        }
+
+        for (uint64_t n : {1, 7, 31, 32, 33, 64, 65, 200, 0x1000}) {
+            for (uint8_t shift = 1; shift < 8; shift++) {
+                auto a = data;
+                auto b = data;
+                k.funnel_shift(a.data(), n, 0xa5, shift);
+                reference.funnel_shift(b.data(), n, 0xa5, shift);
+                ASSERT_EQ(a, b);
+            }
+        }
+    }
+}
+
+TEST(CpuTest, level_1) {
+    auto detected = bitio::detected_cpu_level();
+    auto active = bitio::active_cpu_level();
+    ASSERT_LE(uint8_t(active), uint8_t(detected));
+
+    bitio::set_cpu_level(bitio::cpu_level::scalar);
+    ASSERT_EQ(bitio::active_cpu_level(), bitio::cpu_level::scalar);
+    ASSERT_EQ(&bitio::kernels(), &bitio::kernels(bitio::cpu_level::scalar));
+
+    // Levels above the hardware are capped.
+    bitio::set_cpu_level(bitio::cpu_level::avx512);
+    ASSERT_EQ(bitio::active_cpu_level(), detected);
+
+    bitio::set_cpu_level(active);
+    ASSERT_STREQ(bitio::cpu_level_name(bitio::cpu_level::avx2), "avx2");
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <bitio/int_codec.h>
+#include <random>
+
+static std::vector<uint64_t> series(uint64_t n) {
+    std::mt19937_64 rng(5);
+    std::vector<uint64_t> v(n);
+    uint64_t t = 1600000000000;
+    for (auto &x : v) {
+        t += 1000 + rng() % 16;
+        x = t;
+    }
+    return v;
+}
+
+static uint64_t round_trip(const std::vector<uint64_t> &v, bitio::int_encoding encoding) {
+    std::vector<uint8_t> raw(v.size() * 9 + 64);
+    auto stream = bitio::stream(raw.data(), raw.size());
+    stream.write(0x1, 3);
+    bitio::write_ints(stream, v.data(), v.size(), encoding);
+    uint64_t end = stream.position();
+    stream.write(0x2, 3);
+
+    stream.seek_to(0);
+    EXPECT_EQ(stream.read(3), 0x1);
+    EXPECT_EQ(bitio::read_ints(stream), v);
+    EXPECT_EQ(stream.read(3), 0x2);
+
+    return end - 3;
+}
+
+TEST(IntCodecTest, int_codec_1) {
+    auto v = series(10000);
+
+    uint64_t delta = round_trip(v, bitio::int_encoding::delta);
+    round_trip(v, bitio::int_encoding::frame_of_reference);
+    round_trip(v, bitio::int_encoding::patched);
+    uint64_t best = round_trip(v, bitio::int_encoding::best);
+
+    // Deltas of 1000..1015 take 11 bits instead of 64.
+    ASSERT_LT(delta, v.size() * 12);
+    ASSERT_LE(best, delta);
+}
+
+TEST(IntCodecTest, int_codec_outliers) {
+    std::mt19937_64 rng(9);
+    std::vector<uint64_t> v(1000);
+    for (auto &x : v) {
+        x = rng() % 100;
+    }
+    v[10] = 1ull << 40;
+    v[500] = UINT64_MAX;
+
+    uint64_t frame = round_trip(v, bitio::int_encoding::frame_of_reference);
+    uint64_t patched = round_trip(v, bitio::int_encoding::patched);
+    ASSERT_LT(patched * 2, frame);
+
+    // Signed values, constant runs and edge widths.
+    std::vector<uint64_t> w = {uint64_t(-5), 3, uint64_t(INT64_MIN), uint64_t(INT64_MAX), 0, 0, 0};
+    for (auto encoding : {bitio::int_encoding::delta, bitio::int_encoding::frame_of_reference,
+                          bitio::int_encoding::patched, bitio::int_encoding::best}) {
+        round_trip(w, encoding);
+        round_trip(std::vector<uint64_t>(300, 42), encoding);
+        round_trip({}, encoding);
+    }
+}
+
+TEST(IntCodecTest, int_codec_corrupt) {
+    // A huge count in front of a short body runs out of data instead of allocating for it.
+    uint8_t raw[64]{};
+    auto stream = bitio::stream(raw, sizeof(raw));
+    stream.write(1ull << 60, 0x40);
+
+    stream.seek_to(0);
+    ASSERT_THROW(bitio::read_ints(stream), bitio::bitio_exception);
+    // A patched block with 64-bit values cannot have exceptions.
+    stream.seek_to(0);
+    stream.write(1, 0x40);
+    stream.write(uint64_t(bitio::int_encoding::patched), 2);
+    stream.write(0, 7);
+    stream.write(0x40, 7);
+    stream.write(0, 0x40);
+    stream.write(1, 8);
+    stream.write(0, 7);
+
+    stream.seek_to(0);
+    ASSERT_THROW(bitio::read_ints(stream), bitio::bitio_exception);
+}
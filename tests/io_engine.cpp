@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <bitio/io_engine.h>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct engine_task {
+    struct promise_type {
+        engine_task get_return_object() {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+static engine_task round_trip(bitio::async_stream &s, uint64_t id, int &done) {
+    for (uint64_t i = 0; i < 1000; i++) {
+        co_await s.write(i * id, 37);
+    }
+    co_await s.flush();
+
+    s.sync().seek_to(0);
+    for (uint64_t i = 0; i < 1000; i++) {
+        uint64_t value = co_await s.read(37);
+        EXPECT_EQ(value, i * id);
+    }
+
+    done++;
+}
+
+static void engine_round_trip(uint32_t flags, uint32_t stream_flags) {
+    bitio::io_engine engine(8, flags);
+    std::vector<std::unique_ptr<bitio::stream>> streams;
+    std::vector<std::unique_ptr<bitio::async_stream>> async_streams;
+
+    for (int i = 0; i < 32; i++) {
+        std::string name = "bitio_engine_test_" + std::to_string(i) + ".dat";
+        remove(name.c_str());
+        streams.push_back(std::make_unique<bitio::stream>(name, 64, stream_flags));
+        engine.attach(*streams.back());
+        async_streams.push_back(std::make_unique<bitio::async_stream>(*streams.back(), engine));
+    }
+
+    int done = 0;
+    for (int i = 0; i < 32; i++) {
+        round_trip(*async_streams[i], i + 1, done);
+    }
+
+    while (done < 32) {
+        engine.wait();
+    }
+    ASSERT_EQ(engine.pending(), 0);
+
+    // Dirty pages of all streams go out in one batch and are visible to a fresh reader.
+    for (int i = 0; i < 32; i++) {
+        streams[i]->seek_to(0);
+        streams[i]->write(0x1ffffff, 25);
+    }
+    engine.flush();
+
+    for (int i = 0; i < 32; i++) {
+        std::string name = "bitio_engine_test_" + std::to_string(i) + ".dat";
+        auto reader = bitio::stream(name, 64);
+        ASSERT_EQ(reader.read(25), 0x1ffffff);
+        reader.seek_to(37 * 999);
+        ASSERT_EQ(reader.read(37), 999 * (i + 1));
+    }
+
+    streams.clear();
+    for (int i = 0; i < 32; i++) {
+        std::string name = "bitio_engine_test_" + std::to_string(i) + ".dat";
+        remove(name.c_str());
+    }
+}
+
+TEST(IoEngineTest, io_engine_uring) {
+    engine_round_trip(0, 0);
+}
+
+TEST(IoEngineTest, io_engine_threads) {
+    bitio::io_engine engine(8, BITIO_ENGINE_NO_URING);
+    ASSERT_FALSE(engine.uring());
+
+    engine_round_trip(BITIO_ENGINE_NO_URING, 0);
+}
+
+TEST(IoEngineTest, io_engine_direct) {
+    engine_round_trip(0, BITIO_DIRECT_IO | BITIO_CHECKSUM);
+}
+
+static void engine_write_failure(uint32_t flags) {
+    remove("bitio_engine_fail.dat");
+
+    // The stream gets the lowest free descriptor, which is later swapped for a read-only one.
+    int fd = dup(0);
+    close(fd);
+    auto stream = bitio::stream("bitio_engine_fail.dat", 64);
+    bitio::io_engine engine(8, flags);
+    engine.attach(stream);
+    stream.write(0xab, 8);
+
+    int read_only = open("bitio_engine_fail.dat", O_RDONLY);
+    dup2(read_only, fd);
+    close(read_only);
+    ASSERT_THROW(engine.flush(), bitio::bitio_exception);
+
+    // The page is still dirty and goes out once the file is writable again.
+    int read_write = open("bitio_engine_fail.dat", O_RDWR);
+    dup2(read_write, fd);
+    close(read_write);
+    engine.flush();
+
+    auto reader = bitio::stream("bitio_engine_fail.dat", 64);
+    ASSERT_EQ(reader.read(8), 0xab);
+    remove("bitio_engine_fail.dat");
+}
+
+TEST(IoEngineTest, io_engine_write_failure) {
+    engine_write_failure(0);
+    engine_write_failure(BITIO_ENGINE_NO_URING);
+}
+
+static engine_task wait_for_page(bitio::async_stream &s) {
+    co_await s.ensure(8);
+}
+
+static void engine_release(uint32_t flags) {
+    remove("bitio_engine_release.dat");
+    bitio::io_engine engine(8, flags);
+
+    // Closing a stream whose write-back fails does not throw out of the destructor.
+    int fd = dup(0);
+    close(fd);
+    auto failing = std::make_unique<bitio::stream>("bitio_engine_release.dat", 64);
+    engine.attach(*failing);
+    failing->write(0xcd, 8);
+
+    int read_only = open("bitio_engine_release.dat", O_RDONLY);
+    dup2(read_only, fd);
+    close(read_only);
+    failing.reset();
+    ASSERT_EQ(engine.pending(), 0);
+
+    // Moving a stream with a request in flight waits for the transfer and keeps the stream attached.
+    auto stream = bitio::stream("bitio_engine_release.dat", 64);
+    engine.attach(stream);
+    stream.write(0xab, 8);
+    stream.seek_to(64 * 8 * 3);
+
+    bitio::async_stream async(stream, engine);
+    wait_for_page(async);
+    engine.poll();
+
+    auto moved = std::move(stream);
+    ASSERT_EQ(engine.pending(), 0);
+    moved.seek_to(0);
+    ASSERT_EQ(moved.read(8), 0xab);
+    ASSERT_THROW(engine.attach(moved), bitio::bitio_exception);
+
+    remove("bitio_engine_release.dat");
+}
+
+TEST(IoEngineTest, io_engine_release) {
+    engine_release(0);
+    engine_release(BITIO_ENGINE_NO_URING);
+}
+
+TEST(IoEngineTest, io_engine_attach) {
+    uint8_t raw[4]{};
+    auto memory = bitio::stream(raw, 4);
+    bitio::io_engine engine;
+
+    ASSERT_THROW(engine.attach(memory), bitio::bitio_exception);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <bitio/lanes.h>
+#include <random>
+#include <vector>
+
+template<uint8_t Lanes>
+static void round_trip(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::pair<uint64_t, uint8_t>> expected[Lanes];
+    bitio::lane_writer<Lanes> writer;
+
+    for (int i = 0; i < 2000; i++) {
+        uint8_t lane = rng() % Lanes;
+        uint8_t n = rng() % 64 + 1;
+        uint64_t value = rng() & bitio::low_mask(n);
+        writer.write(lane, value, n);
+        expected[lane].emplace_back(value, n);
+    }
+
+    uint64_t values[Lanes];
+    for (uint8_t lane = 0; lane < Lanes; lane++) {
+        values[lane] = lane * 3 + 1;
+    }
+    writer.write_all(values, 5);
+
+    std::vector<uint8_t> raw(0x10000);
+    auto stream = bitio::stream(raw.data(), raw.size());
+    stream.write(0x3, 3);
+    writer.finish(stream);
+    stream.write(0x1, 1);
+    uint64_t end = stream.position();
+
+    stream.seek_to(3);
+    bitio::lane_reader<Lanes> reader(stream);
+    ASSERT_EQ(stream.position(), end - 1);
+    ASSERT_EQ(stream.read(1), 0x1);
+
+    for (uint8_t lane = 0; lane < Lanes; lane++) {
+        for (auto &[value, n] : expected[lane]) {
+            ASSERT_EQ(reader.read(lane, n), value);
+        }
+        ASSERT_EQ(reader.remaining(lane), 5);
+    }
+
+    reader.read_all(values, 5);
+    for (uint8_t lane = 0; lane < Lanes; lane++) {
+        ASSERT_EQ(values[lane], lane * 3 + 1);
+        ASSERT_EQ(reader.remaining(lane), 0);
+    }
+    ASSERT_FALSE(reader.overrun());
+
+    reader.read_all(values, 64);
+    ASSERT_TRUE(reader.overrun());
+}
+
+TEST(LanesTest, lanes_1) {
+    round_trip<2>(1);
+    round_trip<4>(2);
+    round_trip<8>(3);
+}
+
+TEST(LanesTest, lanes_2) {
+    // Lockstep decoding of four interleaved varint-like streams.
+    bitio::lane_writer<4> writer;
+    for (uint64_t i = 0; i < 1000; i++) {
+        uint64_t values[4] = {i, i * 2, i * 3, i * 4};
+        writer.write_all(values, 12);
+    }
+    ASSERT_EQ(writer.size(3), 12000);
+
+    std::vector<uint8_t> raw(0x2000);
+    auto stream = bitio::stream(raw.data(), raw.size());
+    writer.finish(stream);
+
+    stream.seek_to(0);
+    bitio::lane_reader<4> reader(stream);
+    ASSERT_EQ(reader.peek(1, 12), 0);
+
+    uint64_t values[4];
+    for (uint64_t i = 0; i < 1000; i++) {
+        reader.read_all(values, 12);
+        for (int lane = 0; lane < 4; lane++) {
+            ASSERT_EQ(values[lane], (i * (lane + 1)) & 0xfff);
+        }
+    }
+    ASSERT_FALSE(reader.overrun());
+}
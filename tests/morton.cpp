@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <bitio/morton.h>
+#include <random>
+
+static uint64_t interleave(const uint32_t *coords, int dims, int bits) {
+    uint64_t code = 0;
+    for (int b = 0; b < bits; b++) {
+        for (int d = 0; d < dims; d++) {
+            code |= uint64_t((coords[d] >> b) & 1) << (b * dims + d);
+        }
+    }
+    return code;
+}
+
+TEST(MortonTest, mask_1) {
+    ASSERT_EQ(bitio::extract_mask(0b10110110, 0b11110000), 0b1011);
+    ASSERT_EQ(bitio::extract_mask(0xf0f0f0f0f0f0f0f0ull, 0xff000000000000ffull), 0xf0f0);
+    ASSERT_EQ(bitio::deposit_mask(0b1011, 0b11110000), 0b10110000);
+    ASSERT_EQ(bitio::deposit_mask(0xffff, 0x8000000000000001ull), 0x8000000000000001ull);
+
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 1000; i++) {
+        uint64_t value = rng();
+        uint64_t mask = rng() & rng();
+        ASSERT_EQ(bitio::deposit_mask(bitio::extract_mask(value, mask), mask), value & mask);
+    }
+}
+
+TEST(MortonTest, stream_1) {
+    uint8_t raw[16]{};
+    auto stream = bitio::stream(raw, 16);
+
+    // Flags at every third bit of a 24-bit field.
+    bitio::write_deposit(stream, 0xa5, 0x249249, 24);
+    bitio::write_deposit(stream, 0x3, 0x800001, 24);
+    ASSERT_EQ(raw[0], 0x20);
+    ASSERT_EQ(raw[1], 0x80);
+    ASSERT_EQ(raw[2], 0x41);
+
+    stream.seek_to(0);
+    ASSERT_EQ(bitio::read_extract(stream, 24, 0x249249), 0xa5);
+    ASSERT_EQ(bitio::read_extract(stream, 24, 0x800001), 0x3);
+}
+
+TEST(MortonTest, morton_1) {
+    std::mt19937_64 rng(7);
+    const uint64_t n = 1000;
+    std::vector<uint32_t> x(n), y(n), z(n);
+    for (uint64_t i = 0; i < n; i++) {
+        x[i] = rng();
+        y[i] = rng();
+        z[i] = rng() & 0x1fffff;
+    }
+    x[0] = y[0] = UINT32_MAX;
+
+    std::vector<uint64_t> codes(n);
+    bitio::morton2_encode(x.data(), y.data(), codes.data(), n);
+    for (uint64_t i = 0; i < n; i++) {
+        uint32_t coords[] = {x[i], y[i]};
+        ASSERT_EQ(codes[i], interleave(coords, 2, 32));
+        ASSERT_EQ(bitio::morton2_encode(x[i], y[i]), codes[i]);
+    }
+
+    std::vector<uint32_t> dx(n), dy(n), dz(n);
+    bitio::morton2_decode(codes.data(), dx.data(), dy.data(), n);
+    ASSERT_EQ(dx, x);
+    ASSERT_EQ(dy, y);
+
+    // 3D keeps the low 21 bits of every coordinate.
+    x[0] = y[0] = UINT32_MAX;
+    z[0] = 0x1fffff;
+    bitio::morton3_encode(x.data(), y.data(), z.data(), codes.data(), n);
+    for (uint64_t i = 0; i < n; i++) {
+        uint32_t coords[] = {x[i] & 0x1fffff, y[i] & 0x1fffff, z[i]};
+        ASSERT_EQ(codes[i], interleave(coords, 3, 21));
+        ASSERT_EQ(bitio::morton3_encode(x[i], y[i], z[i]), codes[i]);
+
+        uint32_t cx, cy, cz;
+        bitio::morton3_decode(codes[i], cx, cy, cz);
+        ASSERT_EQ(cx, coords[0]);
+        ASSERT_EQ(cy, coords[1]);
+        ASSERT_EQ(cz, coords[2]);
+    }
+    ASSERT_EQ(codes[0], 0x7fffffffffffffffull);
+
+    bitio::morton3_decode(codes.data(), dx.data(), dy.data(), dz.data(), n);
+    ASSERT_EQ(dz, z);
+}
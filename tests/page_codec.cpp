@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <bitio/bitio.h>
+#include <random>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+TEST(PageCodecTest, rle_codec_1) {
+    std::mt19937_64 rng(5);
+    auto codec = bitio::rle_codec();
+
+    for (int iter = 0; iter < 100; iter++) {
+        std::vector<uint8_t> page(rng() % 5000);
+        for (auto &b : page) {
+            b = rng() % 4 == 0 ? rng() : 0;
+        }
+
+        std::vector<uint8_t> encoded(codec->bound(page.size()));
+        encoded.resize(codec->encode(page.data(), page.size(), encoded.data()));
+
+        std::vector<uint8_t> decoded(page.size());
+        codec->decode(encoded.data(), encoded.size(), decoded.data(), decoded.size());
+        ASSERT_EQ(decoded, page);
+    }
+
+    uint8_t garbage[] = {0x7, 0x1, 0x2};
+    uint8_t out[16];
+    ASSERT_THROW(codec->decode(garbage, 3, out, 16), bitio::bitio_exception);
+}
+
+TEST(PageCodecTest, compressed_stream_1) {
+    remove("bitio_test.dat");
+
+    auto stream = new bitio::stream("bitio_test.dat", 4096, 0, nullptr, bitio::rle_codec());
+    for (int i = 0; i < 100000; i++) {
+        stream->write(i % 1000 == 0 ? i : 0, 24);
+    }
+    stream->flush();
+    ASSERT_EQ(stream->size(), 300000);
+    delete stream;
+
+    FILE *file = fopen("bitio_test.dat", "rb");
+    fseek(file, 0, SEEK_END);
+    ASSERT_LT(ftell(file), 300000 / 10);
+    fclose(file);
+
+    stream = new bitio::stream("bitio_test.dat", 0, 0, nullptr, bitio::rle_codec());
+    ASSERT_EQ(stream->size(), 300000);
+
+    stream->seek_to(24 * 5000);
+    ASSERT_EQ(stream->read(24), 5000);
+    stream->seek_to(24 * 777);
+    ASSERT_EQ(stream->read(24), 0);
+
+    // Rewrite a page in the middle, then scan everything sequentially.
+    stream->seek_to(24 * 12345);
+    stream->write(0xabcdef, 24);
+
+    stream->seek_to(0);
+    for (int i = 0; i < 100000; i++) {
+        uint64_t expected = i == 12345 ? 0xabcdef : (i % 1000 == 0 ? i : 0);
+        ASSERT_EQ(stream->read(24), expected);
+    }
+    delete stream;
+
+    stream = new bitio::stream("bitio_test.dat", 0, 0, nullptr, bitio::rle_codec());
+    stream->seek_to(24 * 12345);
+    ASSERT_EQ(stream->read(24), 0xabcdef);
+    delete stream;
+}
+
+TEST(PageCodecTest, compressed_stream_2) {
+    remove("bitio_test_2.dat");
+
+    // Pages skipped by a seek past the end read back as zeros.
+    auto stream = new bitio::stream("bitio_test_2.dat", 4096, 0, nullptr, bitio::rle_codec());
+    stream->write(0xab, 8);
+    stream->seek_to(8 * 4096 * 5);
+    stream->write(0xcd, 8);
+    delete stream;
+
+    stream = new bitio::stream("bitio_test_2.dat", 0, 0, nullptr, bitio::rle_codec());
+    ASSERT_EQ(stream->size(), 4096 * 5 + 1);
+    ASSERT_EQ(stream->read(8), 0xab);
+    for (uint64_t i = 1; i < 4096 * 5; i++) {
+        ASSERT_EQ(stream->read(8), 0);
+    }
+    ASSERT_EQ(stream->read(8), 0xcd);
+
+    // Closing a stream that only read leaves the file alone.
+    FILE *file = fopen("bitio_test_2.dat", "r+b");
+    fseek(file, -8, SEEK_END);
+    fputc(0x55, file);
+    fclose(file);
+    delete stream;
+
+    file = fopen("bitio_test_2.dat", "rb");
+    fseek(file, -8, SEEK_END);
+    ASSERT_EQ(fgetc(file), 0x55);
+    fclose(file);
+
+    remove("bitio_test_2.dat");
+}
+
+static void patch_trailer(const char *name, long offset, uint64_t value) {
+    FILE *file = fopen(name, "r+b");
+    fseek(file, offset - 32, SEEK_END);
+    for (int i = 7; i >= 0; i--) {
+        fputc(int(value >> (i * 8)) & 0xff, file);
+    }
+    fclose(file);
+}
+
+TEST(PageCodecTest, compressed_stream_3) {
+    remove("bitio_test_3.dat");
+
+    // A failed write-back throws and leaves the page dirty.
+    int fd = dup(0);
+    close(fd);
+    auto stream = new bitio::stream("bitio_test_3.dat", 4096, 0, nullptr, bitio::rle_codec());
+    stream->write(0xabcd, 16);
+
+    int read_only = open("bitio_test_3.dat", O_RDONLY);
+    dup2(read_only, fd);
+    close(read_only);
+    ASSERT_THROW(stream->flush(), bitio::bitio_exception);
+
+    int read_write = open("bitio_test_3.dat", O_RDWR);
+    dup2(read_write, fd);
+    close(read_write);
+    stream->flush();
+    delete stream;
+
+    stream = new bitio::stream("bitio_test_3.dat", 0, 0, nullptr, bitio::rle_codec());
+    ASSERT_EQ(stream->read(16), 0xabcd);
+    delete stream;
+
+    // Trailers with a page size of zero or a page count that does not match the file are rejected.
+    patch_trailer("bitio_test_3.dat", 16, 0);
+    ASSERT_THROW(bitio::stream("bitio_test_3.dat", 0, 0, nullptr, bitio::rle_codec()), bitio::bitio_exception);
+    patch_trailer("bitio_test_3.dat", 16, 4096);
+    patch_trailer("bitio_test_3.dat", 8, 1ull << 60);
+    ASSERT_THROW(bitio::stream("bitio_test_3.dat", 0, 0, nullptr, bitio::rle_codec()), bitio::bitio_exception);
+
+    remove("bitio_test_3.dat");
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <bitio/bitio.h>
+#include <bitio/rank_select.h>
+
+TEST(RankSelectTest, rank_select_1) {
+    uint64_t nbits = 100000;
+    auto raw = new uint8_t[nbits / 8 + 1]();
+    auto stream = bitio::stream(raw, nbits / 8 + 1);
+
+    for (uint64_t i = 0; i < nbits; i++) {
+        stream.write((i % 3 == 0) || (i % 7 == 0), 1);
+    }
+
+    auto rs = bitio::rank_select(stream, 0, nbits);
+
+    uint64_t ones = 0;
+    for (uint64_t i = 0; i < nbits; i++) {
+        bool bit = (i % 3 == 0) || (i % 7 == 0);
+        ASSERT_EQ(rs.rank1(i), ones);
+        ASSERT_EQ(rs.access(i), bit);
+
+        if (bit) {
+            ASSERT_EQ(rs.select1(ones), i);
+            ones++;
+        } else {
+            ASSERT_EQ(rs.select0(i - ones), i);
+        }
+    }
+
+    ASSERT_EQ(rs.ones(), ones);
+    ASSERT_EQ(rs.rank1(nbits), ones);
+    ASSERT_THROW((void) rs.select1(ones), bitio::bitio_exception);
+
+    delete[] raw;
+}
+
+TEST(RankSelectTest, rank_select_sparse) {
+    remove("bitio_test.dat");
+
+    FILE *file = fopen("bitio_test.dat", "w+");
+    auto stream = new bitio::stream(file, 1024);
+
+    uint64_t nbits = 1 << 20;
+    for (uint64_t i = 0; i < nbits; i += 64) {
+        stream->write(i % 40000 == 0, 64);
+    }
+
+    auto rs = bitio::rank_select(*stream, 0, nbits);
+    stream->seek_to(nbits);
+    rs.store(*stream);
+    stream->flush();
+    delete stream;
+
+    file = fopen("bitio_test.dat", "rb+");
+    stream = new bitio::stream(file, 1024);
+    stream->seek_to(nbits);
+    auto loaded = bitio::rank_select::load(*stream, 0);
+
+    uint64_t k = 0;
+    for (uint64_t i = 0; i < nbits; i += 64) {
+        if (i % 40000 == 0) {
+            ASSERT_EQ(loaded.select1(k), i + 63);
+            ASSERT_EQ(loaded.rank1(i + 64), k + 1);
+            k++;
+        }
+    }
+
+    ASSERT_EQ(loaded.ones(), k);
+    ASSERT_EQ(loaded.select0(62), 62);
+    ASSERT_EQ(loaded.select0(63), 64);
+
+    delete stream;
+}
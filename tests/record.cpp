@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <bitio/record.h>
+#include <random>
+#include <vector>
+
+enum class kind : uint8_t {
+    a, b, c, d
+};
+
+struct sample {
+    uint8_t type;
+    uint8_t flags;
+    uint16_t length;
+    bool last;
+    uint64_t payload;
+    int32_t delta;
+    kind k;
+
+    bool operator==(const sample &) const = default;
+};
+
+using sample_schema = bitio::schema<
+        bitio::field<&sample::type, 3>,
+        bitio::field<&sample::flags, 5>,
+        bitio::field<&sample::length, 12>,
+        bitio::field<&sample::last, 1>,
+        bitio::field<&sample::payload, 43>,
+        bitio::field<&sample::delta, 20>,
+        bitio::field<&sample::k, 2>>;
+
+static std::vector<sample> samples(uint64_t n) {
+    std::mt19937_64 rng(11);
+    std::vector<sample> v(n);
+    for (auto &s : v) {
+        s.type = rng() & 0x7;
+        s.flags = rng() & 0x1f;
+        s.length = rng() & 0xfff;
+        s.last = rng() & 1;
+        s.payload = rng() & 0x7ffffffffff;
+        s.delta = int32_t(rng() % (1 << 20)) - (1 << 19);
+        s.k = kind(rng() & 0x3);
+    }
+    return v;
+}
+
+TEST(RecordTest, record_1) {
+    static_assert(sample_schema::bits == 86);
+
+    auto v = samples(100);
+    std::vector<uint8_t> raw(100 * 86 / 8 + 1);
+    auto stream = bitio::stream(raw.data(), raw.size());
+
+    for (auto &s : v) {
+        sample_schema::write(stream, s);
+    }
+
+    // Same layout as writing the fields one by one.
+    stream.seek_to(0);
+    for (auto &s : v) {
+        ASSERT_EQ(stream.read(3), s.type);
+        ASSERT_EQ(stream.read(5), s.flags);
+        ASSERT_EQ(stream.read(12), s.length);
+        ASSERT_EQ(stream.read(1), s.last);
+        ASSERT_EQ(stream.read(43), s.payload);
+        ASSERT_EQ(stream.read(20), uint32_t(s.delta) & 0xfffff);
+        ASSERT_EQ(stream.read(2), uint8_t(s.k));
+    }
+
+    stream.seek_to(0);
+    for (auto &s : v) {
+        ASSERT_EQ(sample_schema::read<sample>(stream), s);
+    }
+}
+
+TEST(RecordTest, record_bulk) {
+    remove("bitio_test.dat");
+    auto v = samples(5000);
+
+    {
+        auto stream = bitio::stream("bitio_test.dat", 1000);
+        stream.write(0x5, 3);
+        sample_schema::write_all(stream, v.data(), v.size());
+        stream.write(0x3, 2);
+        ASSERT_EQ(stream.position(), 3 + 86 * 5000 + 2);
+    }
+
+    auto stream = bitio::stream("bitio_test.dat", 1000);
+    ASSERT_EQ(stream.read(3), 0x5);
+    for (uint64_t i = 0; i < 10; i++) {
+        ASSERT_EQ(sample_schema::read<sample>(stream), v[i]);
+    }
+
+    std::vector<sample> out(v.size() - 10);
+    sample_schema::read_all(stream, out.data(), out.size());
+    for (uint64_t i = 0; i < out.size(); i++) {
+        ASSERT_EQ(out[i], v[i + 10]);
+    }
+    ASSERT_EQ(stream.read(2), 0x3);
+
+    remove("bitio_test.dat");
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <bitio/reverse_writer.h>
+#include <bitio/bits.h>
+#include <random>
+#include <vector>
+
+TEST(ReverseWriterTest, reverse_writer_1) {
+    std::vector<uint8_t> raw(0x8000);
+    auto stream = bitio::stream(raw.data(), raw.size());
+
+    std::mt19937_64 rng(3);
+    std::vector<std::pair<uint64_t, uint8_t>> values;
+    bitio::reverse_writer writer(stream, raw.size() * 8);
+    for (int i = 0; i < 5000; i++) {
+        uint8_t n = rng() % 64 + 1;
+        uint64_t value = rng() & bitio::low_mask(n);
+        writer.write(value, n);
+        values.emplace_back(value, n);
+    }
+
+    uint64_t start = writer.finish();
+    ASSERT_EQ(start, raw.size() * 8 - writer.size());
+    ASSERT_EQ(stream.position(), start);
+
+    for (auto it = values.rbegin(); it != values.rend(); it++) {
+        ASSERT_EQ(stream.read(it->second), it->first);
+    }
+    ASSERT_EQ(stream.position(), raw.size() * 8);
+}
+
+TEST(ReverseWriterTest, reverse_writer_2) {
+    std::remove("reverse_writer_test_2.dat");
+    auto stream = bitio::stream("reverse_writer_test_2.dat", 0x100);
+    stream.write(0x5, 3);
+
+    // Written behind a 3-bit header, then moved up to it.
+    bitio::reverse_writer writer(stream, 0x10000 * 8);
+    for (int i = 0; i < 3000; i++) {
+        writer.write(i, 13);
+    }
+    ASSERT_EQ(writer.finish(3), 3000 * 13);
+
+    stream.seek_to(0);
+    ASSERT_EQ(stream.read(3), 0x5);
+    for (int i = 2999; i >= 0; i--) {
+        ASSERT_EQ(stream.read(13), i);
+    }
+
+    // Nothing can be added once the accumulated bits went out.
+    ASSERT_THROW(writer.write(1, 1), bitio::bitio_exception);
+    ASSERT_THROW(writer.finish(), bitio::bitio_exception);
+    std::remove("reverse_writer_test_2.dat");
+}
+
+TEST(ReverseWriterTest, reverse_writer_3) {
+    uint8_t raw[16]{};
+    auto stream = bitio::stream(raw, 16);
+    ASSERT_THROW(bitio::reverse_writer(stream, 13), bitio::bitio_exception);
+
+    bitio::reverse_writer writer(stream, 64);
+    writer.write(0xffff, 16);
+    writer.write(0xffffffffffffull, 48);
+    writer.write(1, 1);
+    ASSERT_THROW(writer.finish(), bitio::bitio_exception);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <bitio/bitio.h>
+#include <random>
+#include <vector>
+
+TEST(RunsTest, run_1) {
+    std::vector<uint8_t> raw(0x100);
+    auto stream = bitio::stream(raw.data(), raw.size());
+
+    stream.write(0x5, 3);
+    stream.write_run(true, 13);
+    stream.write_run(false, 100);
+    stream.write(1, 1);
+    ASSERT_EQ(stream.position(), 117);
+    ASSERT_EQ(raw[0], 0xbf);
+    ASSERT_EQ(raw[1], 0xff);
+    ASSERT_EQ(raw[2], 0x00);
+    ASSERT_EQ(raw[14], 0x08);
+
+    stream.seek_to(3);
+    ASSERT_EQ(stream.read_run(false), 0);
+    ASSERT_EQ(stream.read_run(true, 5), 5);
+    ASSERT_EQ(stream.read_run(true), 8);
+    ASSERT_EQ(stream.position(), 16);
+    ASSERT_EQ(stream.read_run(false), 100);
+    ASSERT_EQ(stream.read(1), 1);
+
+    // The run ends with the data.
+    ASSERT_EQ(stream.read_run(false), 0x800 - 117);
+    ASSERT_EQ(stream.position(), 0x800);
+    ASSERT_EQ(stream.read_run(false), 0);
+}
+
+TEST(RunsTest, run_2) {
+    remove("bitio_runs.dat");
+    FILE *file = fopen("bitio_runs.dat", "wb+");
+    auto stream = new bitio::stream(file, 0x1000);
+
+    // Runs far longer than a page, each closed by a separator that starts and ends with the opposite bit.
+    std::mt19937_64 rng(47);
+    std::vector<uint64_t> lengths;
+    for (int i = 0; i < 50; i++) {
+        lengths.push_back(rng() % 2 ? rng() % 0x100000 + 1 : rng() % 100 + 1);
+        stream->write_run(i & 1, lengths.back());
+        stream->write(i & 1 ? 0x2b : 0x54, 7);
+    }
+    stream->write_run(false, 10000000);
+    stream->write(1, 1);
+    uint64_t end = stream->position();
+    stream->flush();
+
+    stream->seek_to(0);
+    for (int i = 0; i < 50; i++) {
+        ASSERT_EQ(stream->read_run(i & 1), lengths[i]);
+        ASSERT_EQ(stream->read(7), i & 1 ? 0x2b : 0x54);
+    }
+    ASSERT_EQ(stream->read_run(false), 10000000);
+    ASSERT_EQ(stream->read(1), 1);
+    ASSERT_EQ(stream->position(), end);
+
+    delete stream;
+    remove("bitio_runs.dat");
+}
+
+TEST(RunsTest, unary_1) {
+    std::vector<uint8_t> raw(0x10000);
+    auto stream = bitio::stream(raw.data(), raw.size());
+
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(rng() % (i % 10 ? 20 : 2000));
+        stream.write_unary(values.back());
+    }
+    uint64_t end = stream.position();
+
+    stream.seek_to(0);
+    for (uint64_t i = 0; i < values.size(); i++) {
+        uint64_t value = 0;
+        while (!stream.read(1)) {
+            value++;
+        }
+        ASSERT_EQ(value, values[i]);
+    }
+    ASSERT_EQ(stream.position(), end);
+
+    stream.seek_to(0);
+    for (auto value : values) {
+        ASSERT_EQ(stream.read_unary(), value);
+    }
+    ASSERT_EQ(stream.position(), end);
+
+    // No terminating one before the end of the data.
+    stream.write_run(false, raw.size() * 8 - end);
+    stream.seek_to(end);
+    ASSERT_THROW(stream.read_unary(), bitio::bitio_exception);
+}
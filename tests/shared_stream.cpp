@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <bitio/shared_stream.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST(SharedStreamTest, shared_stream_1) {
+    auto producer = bitio::shared_stream::create(1 << 16);
+    ASSERT_EQ(producer.watermark(), 0);
+
+    // The consumer sees the same pages through its own mapping.
+    auto consumer = bitio::shared_stream::open(producer.fd());
+    ASSERT_EQ(consumer.capacity(), 1 << 16);
+
+    producer.stream().write(0x2a, 7);
+    producer.stream().write(0x1234, 13);
+    ASSERT_EQ(consumer.watermark(), 0);
+
+    producer.publish();
+    ASSERT_EQ(consumer.wait(20), 20);
+
+    auto view = consumer.published();
+    ASSERT_EQ(view.read(7), 0x2a);
+    ASSERT_EQ(view.read(13), 0x1234);
+    ASSERT_THROW(view.read(1), bitio::bitio_exception);
+
+    ASSERT_THROW(producer.publish(8 << 16 | 1), bitio::bitio_exception);
+    ASSERT_THROW(bitio::shared_stream::open(STDERR_FILENO), bitio::bitio_exception);
+}
+
+TEST(SharedStreamTest, shared_stream_fork) {
+    auto producer = bitio::shared_stream::create(1 << 20);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        auto consumer = bitio::shared_stream::open(producer.fd());
+        uint64_t position = 0;
+        for (uint64_t i = 0; i < 100000; i++) {
+            if (position + 33 > consumer.watermark()) {
+                consumer.wait(position + 33);
+            }
+
+            auto view = consumer.published();
+            view.seek_to(position);
+            if (view.read(33) != i * 7) {
+                _exit(1);
+            }
+            position += 33;
+        }
+        _exit(0);
+    }
+
+    for (uint64_t i = 0; i < 100000; i++) {
+        producer.stream().write(i * 7, 33);
+        if (i % 100 == 99) {
+            producer.publish();
+        }
+    }
+    producer.publish();
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
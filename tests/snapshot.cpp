@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <bitio/snapshot.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+TEST(SnapshotTest, snapshot_1) {
+    bitio::cow_stream writer(16);
+    for (int i = 0; i < 100; i++) {
+        writer.write(i, 13);
+    }
+
+    auto before = writer.snapshot();
+
+    // Overwrite the start and keep appending, the snapshot must not see either.
+    writer.seek_to(0);
+    writer.write(0x1fff, 13);
+    writer.seek_to(writer.size());
+    for (int i = 100; i < 200; i++) {
+        writer.write(i, 13);
+    }
+
+    ASSERT_EQ(before.size(), 1300);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(before.read(13), i);
+    }
+    ASSERT_THROW(before.read(1), bitio::bitio_exception);
+
+    auto after = writer.snapshot();
+    ASSERT_EQ(after.read(13), 0x1fff);
+    after.seek_to(13 * 150);
+    ASSERT_EQ(after.read(13), 150);
+
+    writer.seek_to(13 * 199);
+    ASSERT_EQ(writer.read(13), 199);
+}
+
+TEST(SnapshotTest, snapshot_concurrent) {
+    bitio::cow_stream writer(64);
+    std::mutex mutex;
+    bitio::snapshot latest;
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> readers;
+    std::atomic<uint64_t> checked{0};
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                bitio::snapshot s;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    s = latest;
+                }
+
+                for (uint64_t i = 0; i < s.size() / 24; i++) {
+                    ASSERT_EQ(s.read(24), i & 0xffffff);
+                }
+                checked += s.size() / 24;
+            }
+        });
+    }
+
+    for (uint64_t i = 0; i < 100000; i++) {
+        writer.write(i, 24);
+        if (i % 1000 == 0) {
+            auto s = writer.snapshot();
+            std::lock_guard<std::mutex> lock(mutex);
+            latest = s;
+        }
+    }
+
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <bitio/streambuf.h>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+TEST(StreambufTest, backend_1) {
+    std::vector<uint8_t> raw(0x400);
+    auto reference = bitio::stream(raw.data(), raw.size());
+
+    std::stringstream buffer;
+    {
+        auto stream = bitio::stream(buffer.rdbuf(), 0x40);
+        for (int i = 0; i < 500; i++) {
+            stream.write(i * 0x9e3779b9u, 13);
+            reference.write(i * 0x9e3779b9u, 13);
+        }
+
+        // Pages go back and forth through the buffer.
+        stream.seek_to(0);
+        ASSERT_EQ(stream.read(13), 0);
+        ASSERT_EQ(stream.read(13), 0x9e3779b9u & 0x1fff);
+    }
+
+    std::string data = buffer.str();
+    ASSERT_EQ(data.size(), (500 * 13 + 7) / 8);
+    ASSERT_EQ(data, std::string(raw.begin(), raw.begin() + data.size()));
+
+    auto stream = bitio::stream(buffer.rdbuf(), 0x40);
+    ASSERT_EQ(stream.size(), data.size());
+    stream.seek_to(13 * 400);
+    ASSERT_EQ(stream.read(13), (400 * 0x9e3779b9u) & 0x1fff);
+}
+
+TEST(StreambufTest, backend_2) {
+    std::stringstream buffer;
+    {
+        auto stream = bitio::stream(buffer.rdbuf(), 0x20, BITIO_STREAMING_OUT);
+        for (int i = 0; i < 1000; i++) {
+            stream.write(i, 10);
+        }
+    }
+
+    ASSERT_EQ(buffer.str().size(), 1250);
+
+    std::istringstream input(buffer.str());
+    auto stream = bitio::stream(input.rdbuf(), 0x20, BITIO_STREAMING_IN);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(stream.read(10), i);
+    }
+    ASSERT_THROW(stream.read(8), bitio::bitio_exception);
+}
+
+TEST(StreambufTest, backend_3) {
+    std::stringstream buffer;
+    {
+        auto stream = bitio::stream(buffer.rdbuf(), 16);
+        stream.write(0xaa, 8);
+        stream.seek_to(40 * 8);
+        stream.write(0xcd, 8);
+        stream.flush();
+
+        // The page past the end of the buffer loads empty.
+        stream.seek_to(40 * 8);
+        ASSERT_EQ(stream.read(8), 0xcd);
+    }
+
+    std::string data = buffer.str();
+    ASSERT_EQ(data.size(), 41);
+    ASSERT_EQ(uint8_t(data[0]), 0xaa);
+    ASSERT_EQ(data.substr(1, 39), std::string(39, 0));
+    ASSERT_EQ(uint8_t(data[40]), 0xcd);
+}
+
+// A sink that takes a few bytes and then refuses.
+struct full_buffer : std::stringbuf {
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        n = std::min<std::streamsize>(n, 4 - std::streamsize(str().size()));
+        return n > 0 ? std::stringbuf::xsputn(s, n) : 0;
+    }
+};
+
+TEST(StreambufTest, backend_4) {
+    full_buffer buffer;
+    auto stream = bitio::stream(&buffer, 16);
+    stream.write(0x123456789a, 40);
+    ASSERT_THROW(stream.flush(), bitio::bitio_exception);
+}
+
+TEST(StreambufTest, view_1) {
+    std::vector<uint8_t> raw(0x100);
+    auto stream = bitio::stream(raw.data(), raw.size());
+    stream.write(0xa, 4);
+    ASSERT_THROW(bitio::streambuf view(stream), bitio::bitio_exception);
+    stream.write(0xb, 4);
+
+    {
+        bitio::streambuf view(stream);
+        std::ostream out(&view);
+        out << "hello " << 42;
+        out.write(std::string(0x1000, 'x').data(), 0x10).flush();
+    }
+    ASSERT_EQ(stream.position(), (1 + 8 + 16) * 8);
+    ASSERT_EQ(raw[0], 0xab);
+    ASSERT_EQ(std::string(raw.begin() + 1, raw.begin() + 9), "hello 42");
+    ASSERT_EQ(raw[9], 'x');
+
+    stream.seek_to(8);
+    {
+        bitio::streambuf view(stream);
+        std::istream in(&view);
+        std::string word;
+        int number;
+        in >> word >> number;
+        ASSERT_EQ(word, "hello");
+        ASSERT_EQ(number, 42);
+
+        in.seekg(0, std::ios_base::end);
+        ASSERT_EQ(in.tellg(), 0xff);
+        in.seekg(-2, std::ios_base::cur);
+        ASSERT_EQ(in.get(), 0);
+        ASSERT_EQ(in.get(), 0);
+        ASSERT_EQ(in.get(), EOF);
+    }
+}
+
+TEST(StreambufTest, view_2) {
+    std::vector<uint8_t> raw(0x3000);
+    auto stream = bitio::stream(raw.data(), raw.size());
+
+    // Large writes skip the put area, reads come straight from the page.
+    std::string payload;
+    for (int i = 0; i < 0x2000; i++) {
+        payload.push_back(char(i * 7));
+    }
+
+    {
+        bitio::streambuf view(stream);
+        std::ostream out(&view);
+        out.put('<');
+        out.write(payload.data(), payload.size());
+        out.put('>');
+    }
+
+    stream.seek_to(0);
+    ASSERT_EQ(stream.read(8), '<');
+    bitio::streambuf view(stream);
+    std::istream in(&view);
+    std::string back(payload.size(), 0);
+    in.read(back.data(), back.size());
+    ASSERT_EQ(back, payload);
+    ASSERT_EQ(in.get(), '>');
+}
+
+TEST(StreambufTest, view_3) {
+    uint8_t raw[16]{};
+    auto stream = bitio::stream(raw, sizeof(raw));
+
+    // Writes past the end of the stream fail the ostream instead of throwing.
+    {
+        bitio::streambuf view(stream);
+        std::ostream out(&view);
+        out << std::string(19, 'y');
+        out.flush();
+        ASSERT_TRUE(out.bad());
+    }
+    ASSERT_EQ(raw[15], 'y');
+    ASSERT_EQ(stream.position(), 16 * 8);
+
+    stream.seek_to(8 * 8);
+    {
+        bitio::streambuf view(stream);
+        std::ostream out(&view);
+        out.write(std::string(0x2000, 'z').data(), 0x2000);
+        ASSERT_TRUE(out.bad());
+    }
+    ASSERT_EQ(raw[8], 'z');
+    ASSERT_EQ(raw[15], 'z');
+
+    // Bytes still in the put area when the view goes away are dropped quietly.
+    stream.seek_to(12 * 8);
+    {
+        bitio::streambuf view(stream);
+        std::ostream out(&view);
+        out << "0123456789";
+    }
+    ASSERT_EQ(raw[15], '3');
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <bitio/trace.h>
+
+TEST(TraceTest, trace_1) {
+    std::remove("trace_test_1.trace");
+    {
+        bitio::trace_recorder recorder("trace_test_1.trace");
+        uint8_t raw[64]{};
+        auto stream = bitio::stream(raw, 64);
+
+        stream.write(1, 1);
+        stream.trace(&recorder);
+        stream.write(0xabc, 12);
+        stream.seek(-13);
+        stream.read(64);
+        stream.read(0);
+        stream.seek_to(300);
+        stream.seek(7);
+        stream.flush();
+        stream.trace(nullptr);
+        stream.read(8);
+
+        ASSERT_EQ(recorder.events(), 8);
+    }
+
+    bitio::trace_reader reader("trace_test_1.trace");
+    std::vector<std::pair<bitio::trace_op, uint64_t>> expected = {
+            {bitio::trace_op::begin,   64},
+            {bitio::trace_op::seek_to, 1},
+            {bitio::trace_op::write,   12},
+            {bitio::trace_op::seek,    uint64_t(-13)},
+            {bitio::trace_op::read,    64},
+            {bitio::trace_op::seek_to, 300},
+            {bitio::trace_op::seek,    7},
+            {bitio::trace_op::flush,   0},
+    };
+
+    bitio::trace_event event{};
+    for (auto &[op, value] : expected) {
+        ASSERT_TRUE(reader.next(event));
+        ASSERT_EQ(event.op, op);
+        ASSERT_EQ(event.value, value);
+    }
+    ASSERT_FALSE(reader.next(event));
+    std::remove("trace_test_1.trace");
+}
+
+TEST(TraceTest, trace_2) {
+    std::remove("trace_test_2.trace");
+    {
+        bitio::trace_recorder recorder("trace_test_2.trace");
+        uint8_t raw[64]{};
+        auto stream = bitio::stream(raw, 64);
+        stream.trace(&recorder);
+
+        // Runs move the cursor past the bytes they fill or scan, the trace has to follow.
+        stream.write_run(true, 20);
+        stream.seek_to(0);
+        ASSERT_EQ(stream.read_run(true), 20);
+        stream.trace(nullptr);
+    }
+
+    bitio::trace_reader reader("trace_test_2.trace");
+    std::vector<std::pair<bitio::trace_op, uint64_t>> expected = {
+            {bitio::trace_op::begin,   64},
+            {bitio::trace_op::seek_to, 0},
+            {bitio::trace_op::seek_to, 16},
+            {bitio::trace_op::write,   4},
+            {bitio::trace_op::seek_to, 0},
+            {bitio::trace_op::seek_to, 20},
+    };
+
+    bitio::trace_event event{};
+    for (auto &[op, value] : expected) {
+        ASSERT_TRUE(reader.next(event));
+        ASSERT_EQ(event.op, op);
+        ASSERT_EQ(event.value, value);
+    }
+    ASSERT_FALSE(reader.next(event));
+    std::remove("trace_test_2.trace");
+}
+
+TEST(TraceTest, stats_1) {
+    std::remove("trace_test_2.dat");
+    auto stream = bitio::stream("trace_test_2.dat", 16);
+
+    for (int i = 0; i < 64; i++) {
+        stream.write(i, 8);
+    }
+    stream.flush();
+
+    // Every page is written back exactly once.
+    auto stats = stream.stats();
+    ASSERT_EQ(stats.page_commits, 4);
+    ASSERT_EQ(stats.bytes_committed, 64);
+
+    stream.seek_to(0);
+    for (int i = 0; i < 64; i++) {
+        ASSERT_EQ(stream.read(8), i);
+    }
+    ASSERT_EQ(stream.stats().page_loads, stats.page_loads + 4);
+    ASSERT_EQ(stream.stats().bytes_loaded, stats.bytes_loaded + 64);
+    ASSERT_EQ(stream.stats().page_commits, 4);
+
+    // Rewriting the middle of a page only writes from the first changed byte on.
+    stream.seek_to(8 * 20);
+    stream.write(0xff, 8);
+    stream.flush();
+    ASSERT_EQ(stream.stats().page_commits, 5);
+    ASSERT_EQ(stream.stats().bytes_committed, 64 + 12);
+    std::remove("trace_test_2.dat");
+}